@@ -0,0 +1,232 @@
+/* Checks that the SIMD and scalar code paths in Vorbis.c produce identical output */
+/* Build and run from this folder with:
+     cc -O2 -DVORBIS_TEST_IMPL -DVORBIS_NO_SIMD -c VorbisSIMDTest.c -o vorbis_scalar.o
+     cc -O2 -DVORBIS_TEST_IMPL -c VorbisSIMDTest.c -o vorbis_simd.o
+     cc -O2 VorbisSIMDTest.c vorbis_scalar.o vorbis_simd.o -lm -o VorbisSIMDTest
+     ./VorbisSIMDTest
+*/
+#ifdef VORBIS_TEST_IMPL
+/* Compiles Vorbis.c with its exported functions renamed, so both variants can be linked together */
+#ifdef VORBIS_NO_SIMD
+#define VT_NAME(func) Scalar_##func
+#else
+#define VT_NAME(func) SIMD_##func
+#endif
+
+#define Ogg_Init             VT_NAME(Ogg_Init)
+#define imdct_init           VT_NAME(imdct_init)
+#define imdct_calc           VT_NAME(imdct_calc)
+#define Vorbis_Init          VT_NAME(Vorbis_Init)
+#define Vorbis_Free          VT_NAME(Vorbis_Free)
+#define Vorbis_DecodeHeaders VT_NAME(Vorbis_DecodeHeaders)
+#define Vorbis_DecodeFrame   VT_NAME(Vorbis_DecodeFrame)
+#define Vorbis_OutputFrame   VT_NAME(Vorbis_OutputFrame)
+#include "../../src/Vorbis.c"
+#else
+
+#include "../../src/Vorbis.h"
+#include "../../src/Errors.h"
+#include "../../src/ExtMath.h"
+#include "../../src/Platform.h"
+#include "../../src/Stream.h"
+#include "../../src/Utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void Scalar_imdct_init(struct imdct_state* state, int n);
+void Scalar_imdct_calc(float* in, float* out, struct imdct_state* state);
+int  Scalar_Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data);
+void SIMD_imdct_init(struct imdct_state* state, int n);
+void SIMD_imdct_calc(float* in, float* out, struct imdct_state* state);
+int  SIMD_Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data);
+
+
+/*########################################################################################################################*
+*--------------------------------------------------Functions Vorbis.c uses------------------------------------------------*
+*#########################################################################################################################*/
+float Math_SinF(float x) { return sinf(x); }
+float Math_CosF(float x) { return cosf(x); }
+cc_bool Math_IsPowOf2(int value) { return value != 0 && (value & (value - 1)) == 0; }
+
+int Math_ilog2(cc_uint32 value) {
+	int r = 0;
+	while (value >>= 1) r++;
+	return r;
+}
+
+cc_uint32 Mem_ReadU32_LE(const void* src) {
+	const cc_uint8* p = (const cc_uint8*)src;
+	return (cc_uint32)p[0] | ((cc_uint32)p[1] << 8) | ((cc_uint32)p[2] << 16) | ((cc_uint32)p[3] << 24);
+}
+
+cc_uint32 Mem_ReadU32_BE(const void* src) {
+	const cc_uint8* p = (const cc_uint8*)src;
+	return ((cc_uint32)p[0] << 24) | ((cc_uint32)p[1] << 16) | ((cc_uint32)p[2] << 8) | (cc_uint32)p[3];
+}
+
+void* Mem_TryAlloc(cc_uint32 numElems, cc_uint32 elemsSize)        { return malloc((size_t)numElems * elemsSize); }
+void* Mem_TryAllocCleared(cc_uint32 numElems, cc_uint32 elemsSize) { return calloc(numElems, elemsSize); }
+
+void* Mem_Alloc(cc_uint32 numElems, cc_uint32 elemsSize, const char* place) {
+	void* ptr = Mem_TryAlloc(numElems, elemsSize);
+	if (!ptr) Process_Abort2(ERR_OUT_OF_MEMORY, place);
+	return ptr;
+}
+
+void* Mem_AllocCleared(cc_uint32 numElems, cc_uint32 elemsSize, const char* place) {
+	void* ptr = Mem_TryAllocCleared(numElems, elemsSize);
+	if (!ptr) Process_Abort2(ERR_OUT_OF_MEMORY, place);
+	return ptr;
+}
+
+void  Mem_Free(void* mem) { free(mem); }
+void* Mem_Set(void* dst, cc_uint8 value, unsigned numBytes)     { return memset(dst, value, numBytes); }
+void* Mem_Copy(void* dst, const void* src, unsigned numBytes)   { return memcpy(dst, src, numBytes); }
+
+void Process_Abort2(cc_result result, const char* raw_msg) {
+	printf("ABORT: %s (%x)\n", raw_msg, result);
+	exit(2);
+}
+
+cc_result Stream_Read(struct Stream* s, cc_uint8* buffer, cc_uint32 count) { return ERR_END_OF_STREAM; }
+
+
+/*########################################################################################################################*
+*----------------------------------------------------------Tests----------------------------------------------------------*
+*#########################################################################################################################*/
+static cc_uint32 rng_state = 0x12345678;
+static int failures;
+
+/* Returns a deterministic pseudo random float between min and max */
+static float RandomFloat(float min, float max) {
+	rng_state = rng_state * 1664525 + 1013904223;
+	return min + (max - min) * ((rng_state >> 8) / 16777216.0f);
+}
+
+static void Check(int ok, const char* what, int arg) {
+	if (ok) return;
+	printf("FAILED: %s (%i)\n", what, arg);
+	failures++;
+}
+
+static float in1[VORBIS_MAX_BLOCK_SIZE / 2], in2[VORBIS_MAX_BLOCK_SIZE / 2];
+static float out1[VORBIS_MAX_BLOCK_SIZE],    out2[VORBIS_MAX_BLOCK_SIZE];
+static struct imdct_state imdct1, imdct2;
+
+static void TestImdct(int n) {
+	int i;
+	for (i = 0; i < n / 2; i++) { in1[i] = in2[i] = RandomFloat(-1.0f, 1.0f); }
+
+	Scalar_imdct_init(&imdct1, n);
+	SIMD_imdct_init(&imdct2, n);
+	Scalar_imdct_calc(in1, out1, &imdct1);
+	SIMD_imdct_calc(in2,   out2, &imdct2);
+	Check(memcmp(out1, out2, n * sizeof(float)) == 0, "imdct_calc output differs, block size", n);
+}
+
+#define TEST_SHORT_BLOCK 256
+#define TEST_LONG_BLOCK  2048
+static float prevData[VORBIS_MAX_CHANS][TEST_LONG_BLOCK];
+static float  curData[VORBIS_MAX_CHANS][TEST_LONG_BLOCK];
+static float windowData[2][2][TEST_LONG_BLOCK / 2];
+static cc_int16 pcm1[TEST_LONG_BLOCK * VORBIS_MAX_CHANS];
+static cc_int16 pcm2[TEST_LONG_BLOCK * VORBIS_MAX_CHANS];
+
+/* Returns a random sample, which is sometimes out of range or not finite */
+static float RandomSample(void) {
+	rng_state = rng_state * 1664525 + 1013904223;
+	switch (rng_state >> 28) {
+	case 0: return (float)NAN;
+	case 1: return (float)INFINITY;
+	case 2: return -(float)INFINITY;
+	case 3: return  1.0f;
+	case 4: return -1.0f;
+	}
+	return RandomFloat(-1.5f, 1.5f);
+}
+
+static int OutputFrame(struct VorbisState* ctx, cc_int16* data, int simd) {
+	int prevBlockSize = ctx->prevBlockSize;
+	int count = simd ? SIMD_Vorbis_OutputFrame(ctx, data) : Scalar_Vorbis_OutputFrame(ctx, data);
+	ctx->prevBlockSize = prevBlockSize;
+	return count;
+}
+
+static void TestOutputFrame(int channels, int prevSize, int curSize, int allNaN) {
+	struct VorbisState ctx = { 0 };
+	int i, j, ch, count1, count2;
+
+	ctx.channels      = channels;
+	ctx.blockSizes[0] = TEST_SHORT_BLOCK;
+	ctx.blockSizes[1] = TEST_LONG_BLOCK;
+	ctx.prevBlockSize = prevSize;
+	ctx.curBlockSize  = curSize;
+
+	for (ch = 0; ch < channels; ch++)
+	{
+		ctx.prevOutput[ch] = prevData[ch];
+		ctx.curOutput[ch]  = curData[ch];
+
+		for (i = 0; i < TEST_LONG_BLOCK; i++)
+		{
+			prevData[ch][i] = allNaN ? (float)NAN : RandomSample();
+			curData[ch][i]  = allNaN ? (float)NAN : RandomSample();
+		}
+	}
+
+	for (i = 0; i < 2; i++)
+	{
+		ctx.windows[i].Prev = windowData[i][0];
+		ctx.windows[i].Cur  = windowData[i][1];
+
+		for (j = 0; j < ctx.blockSizes[i] / 2; j++)
+		{
+			windowData[i][0][j] = RandomFloat(0.0f, 1.0f);
+			windowData[i][1][j] = RandomFloat(0.0f, 1.0f);
+		}
+	}
+
+	Mem_Set(pcm1, 0x55, sizeof(pcm1));
+	Mem_Set(pcm2, 0x55, sizeof(pcm2));
+	count1 = OutputFrame(&ctx, pcm1, false);
+	count2 = OutputFrame(&ctx, pcm2, true);
+
+	Check(count1 == count2, "Vorbis_OutputFrame count differs, channels", channels);
+	Check(memcmp(pcm1, pcm2, sizeof(pcm1)) == 0, "Vorbis_OutputFrame output differs, channels", channels);
+	if (!allNaN) return;
+
+	for (i = 0; i < count1; i++)
+	{
+		if (pcm1[i] == 0) continue;
+		Check(false, "NaN samples not output as silence, index", i);
+		break;
+	}
+}
+
+int main(void) {
+	int n, ch;
+#if !(defined __x86_64__ || defined _M_X64 || defined _M_AMD64)
+	printf("NOTE: No SIMD code path for this architecture, scalar is compared against scalar\n");
+#endif
+
+	for (n = 64; n <= VORBIS_MAX_BLOCK_SIZE; n *= 2)
+	{
+		TestImdct(n);
+	}
+
+	for (ch = 1; ch <= VORBIS_MAX_CHANS; ch++)
+	{
+		TestOutputFrame(ch, TEST_SHORT_BLOCK, TEST_SHORT_BLOCK, false);
+		TestOutputFrame(ch, TEST_SHORT_BLOCK, TEST_LONG_BLOCK,  false);
+		TestOutputFrame(ch, TEST_LONG_BLOCK,  TEST_SHORT_BLOCK, false);
+		TestOutputFrame(ch, TEST_LONG_BLOCK,  TEST_LONG_BLOCK,  false);
+		TestOutputFrame(ch, TEST_LONG_BLOCK,  TEST_SHORT_BLOCK, true);
+	}
+
+	if (failures) { printf("%i checks failed\n", failures); return 1; }
+	printf("All checks passed\n");
+	return 0;
+}
+#endif
@@ -1,4 +1,9 @@
 #include "Audio.h"
+/* Included before Funcs.h, as C++ standard headers may undefine min/max */
+#if defined __x86_64__ || defined _M_X64 || defined _M_AMD64
+#include <emmintrin.h>
+#define MIXER_USE_SSE2
+#endif
 #include "String_.h"
 #include "Logger.h"
 #include "Event.h"
@@ -13,6 +18,7 @@
 #include "Utils.h"
 #include "Options.h"
 #include "Deflate.h"
+#include "Camera.h"
 #ifdef CC_BUILD_MOBILE
 /* TODO: Refactor maybe to not rely on checking WinInfo.Handle != NULL */
 #include "Window.h"
@@ -170,16 +176,308 @@ static const struct Sound* Soundboard_PickRandom(struct Soundboard* board, cc_ui
 }
 
 
+#ifdef CC_BUILD_COOPTHREADED
+/* No background threads, so sounds are played using a pool of backend sound contexts */
 CC_NOINLINE static void Sounds_Fail(cc_result res) {
 	Audio_Warn(res, "playing sounds");
 	Chat_AddRaw("&cDisabling sounds");
 	Audio_SetSounds(0);
 }
 
-static void Sounds_Play(cc_uint8 type, struct Soundboard* board) {
+static void Sounds_PlayData(struct AudioData* data, const struct Sound* snd, float distSq) {
+	cc_result res = AudioPool_Play(data);
+	if (res) Sounds_Fail(res);
+}
+
+static void Mixer_Init(void)  { }
+static void Mixer_Free(void)  { }
+static void Mixer_Start(void) { }
+static void Mixer_Stop(void)  { AudioPool_Close(); }
+#else
+/*########################################################################################################################*
+*------------------------------------------------------Sound mixer--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Sounds are resampled and mixed together on a background thread, then played on a single stream context */
+#define MIXER_MAX_VOICES   32
+#define MIXER_SAMPLE_RATE  44100
+#define MIXER_CHUNK_FRAMES 512 /* ~12 milliseconds of audio */
+#define MIXER_CHUNK_SIZE   (MIXER_CHUNK_FRAMES * 2 * 2)
+#define MIXER_ONE          0x10000 /* 1.0 in 16.16 fixed point */
+
+struct MixerVoice {
+	const struct Sound* snd; /* NULL when voice is not playing anything */
+	cc_uint32 frame, frac;   /* position in the sound, with frac as a 16.16 fixed point fraction */
+	cc_uint32 step;          /* frames of the sound advanced per output frame, in 16.16 fixed point */
+	int volume;              /* volume, where 256 = normal volume */
+	float distSq;            /* squared distance from the camera when the sound was played */
+};
+
+static struct MixerVoice mixer_voices[MIXER_MAX_VOICES];
+static void* mixer_mutex;
+static void* mixer_waitable;
+static void* mixer_thread;
+static volatile cc_bool mixer_stopping, mixer_joining;
+
+static void Mixer_Play(const struct Sound* snd, int volume, int rate, float distSq) {
+	struct MixerVoice* voice = NULL;
+	struct MixerVoice* v;
+	int i;
+	if (snd->channels != 1 && snd->channels != 2) return;
+	Mutex_Lock(mixer_mutex);
+
+	for (i = 0; i < MIXER_MAX_VOICES; i++) 
+	{
+		v = &mixer_voices[i];
+		if (!v->snd) { voice = v; break; }
+
+		/* When all voices are in use, steal the furthest away voice */
+		/*  (or the one furthest through its sound for voices equally far away) */
+		if (!voice || v->distSq > voice->distSq || (v->distSq == voice->distSq && v->frame > voice->frame)) {
+			voice = v;
+		}
+	}
+
+	/* Don't interrupt sounds closer to the camera than this one */
+	if (voice->snd && voice->distSq < distSq) {
+		Mutex_Unlock(mixer_mutex); return;
+	}
+
+	voice->snd    = snd;
+	voice->frame  = 0;
+	voice->frac   = 0;
+	voice->step   = (cc_uint32)(((cc_uint64)snd->sampleRate * rate * MIXER_ONE) / (MIXER_SAMPLE_RATE * 100));
+	voice->volume = volume * 256 / 100;
+	voice->distSq = distSq;
+
+	Mutex_Unlock(mixer_mutex);
+	Waitable_Signal(mixer_waitable);
+}
+
+static cc_bool Mixer_AnyPlaying(void) {
+	cc_bool playing = false;
+	int i;
+	Mutex_Lock(mixer_mutex);
+
+	for (i = 0; i < MIXER_MAX_VOICES; i++) 
+	{
+		if (mixer_voices[i].snd) { playing = true; break; }
+	}
+	Mutex_Unlock(mixer_mutex);
+	return playing;
+}
+
+#ifdef MIXER_USE_SSE2
+/* Mixes a voice that doesn't need resampling, returns number of frames mixed */
+static int Mixer_MixDirect_SSE2(const cc_int16* src, int channels, cc_int32* mix, int frames, int volume) {
+	__m128i vol = _mm_set1_epi16((short)volume);
+	__m128i s, lo, hi, p0, p1;
+	int i;
+
+	if (channels == 1) {
+		for (i = 0; i + 8 <= frames; i += 8, mix += 16) 
+		{
+			s  = _mm_loadu_si128((const __m128i*)(src + i));
+			lo = _mm_mullo_epi16(s, vol); hi = _mm_mulhi_epi16(s, vol);
+			p0 = _mm_unpacklo_epi16(lo, hi);
+			p1 = _mm_unpackhi_epi16(lo, hi);
+
+			/* mono samples are played on both output channels */
+			_mm_storeu_si128((__m128i*)(mix +  0), _mm_add_epi32(_mm_loadu_si128((__m128i*)(mix +  0)), _mm_unpacklo_epi32(p0, p0)));
+			_mm_storeu_si128((__m128i*)(mix +  4), _mm_add_epi32(_mm_loadu_si128((__m128i*)(mix +  4)), _mm_unpackhi_epi32(p0, p0)));
+			_mm_storeu_si128((__m128i*)(mix +  8), _mm_add_epi32(_mm_loadu_si128((__m128i*)(mix +  8)), _mm_unpacklo_epi32(p1, p1)));
+			_mm_storeu_si128((__m128i*)(mix + 12), _mm_add_epi32(_mm_loadu_si128((__m128i*)(mix + 12)), _mm_unpackhi_epi32(p1, p1)));
+		}
+	} else {
+		for (i = 0; i + 4 <= frames; i += 4, mix += 8) 
+		{
+			s  = _mm_loadu_si128((const __m128i*)(src + i * 2));
+			lo = _mm_mullo_epi16(s, vol); hi = _mm_mulhi_epi16(s, vol);
+			p0 = _mm_unpacklo_epi16(lo, hi);
+			p1 = _mm_unpackhi_epi16(lo, hi);
+
+			_mm_storeu_si128((__m128i*)(mix + 0), _mm_add_epi32(_mm_loadu_si128((__m128i*)(mix + 0)), p0));
+			_mm_storeu_si128((__m128i*)(mix + 4), _mm_add_epi32(_mm_loadu_si128((__m128i*)(mix + 4)), p1));
+		}
+	}
+	return i;
+}
+#endif
+
+/* Linearly interpolates between two samples, using a 16.16 fixed point fraction */
+#define Mixer_Lerp(a, b, frac) ((a) + ((((b) - (a)) * (int)((frac) >> 1)) >> 15))
+
+static void Mixer_MixVoice(struct MixerVoice* v, cc_int32* mix) {
+	const struct Sound* snd = v->snd;
+	const cc_int16* src = (const cc_int16*)snd->chunk.data;
+	cc_uint32 count = snd->chunk.size / (2 * snd->channels);
+	cc_uint32 frame = v->frame, frac = v->frac;
+	int i = 0, a, b, l, r, vol = v->volume;
+#ifdef MIXER_USE_SSE2
+	int frames;
+
+	if (v->step == MIXER_ONE && !frac) {
+		frames = (int)min(count - frame, MIXER_CHUNK_FRAMES);
+		i = Mixer_MixDirect_SSE2(src + frame * snd->channels, snd->channels, mix, frames, vol);
+		frame += i;
+	}
+#endif
+
+	for (; i < MIXER_CHUNK_FRAMES && frame < count; i++) 
+	{
+		if (snd->channels == 1) {
+			a = src[frame];
+			b = frame + 1 < count ? src[frame + 1] : a;
+			l = Mixer_Lerp(a, b, frac);
+			r = l;
+		} else {
+			a = src[frame * 2 + 0];
+			b = frame + 1 < count ? src[frame * 2 + 2] : a;
+			l = Mixer_Lerp(a, b, frac);
+
+			a = src[frame * 2 + 1];
+			b = frame + 1 < count ? src[frame * 2 + 3] : a;
+			r = Mixer_Lerp(a, b, frac);
+		}
+
+		mix[i * 2 + 0] += l * vol;
+		mix[i * 2 + 1] += r * vol;
+
+		frac  += v->step;
+		frame += frac >> 16;
+		frac  &= 0xFFFF;
+	}
+
+	v->frame = frame;
+	v->frac  = frac;
+	if (frame >= count) v->snd = NULL;
+}
+
+/* Converts mixed samples back into 16 bit samples */
+static void Mixer_Output(const cc_int32* mix, cc_int16* dst, int count) {
+	int i = 0, sample;
+
+#ifdef MIXER_USE_SSE2
+	for (; i + 8 <= count; i += 8) 
+	{
+		__m128i lo = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(mix + i)),     8);
+		__m128i hi = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(mix + i + 4)), 8);
+		/* packing saturates samples to between -32768 and 32767 */
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+#endif
+
+	for (; i < count; i++) 
+	{
+		sample = mix[i] >> 8;
+		Math_Clamp(sample, -32768, 32767);
+		dst[i] = (cc_int16)sample;
+	}
+}
+
+static void Mixer_Mix(struct AudioChunk* chunk) {
+	static cc_int32 mix[MIXER_CHUNK_FRAMES * 2];
+	int i;
+	Mem_Set(mix, 0, sizeof(mix));
+	Mutex_Lock(mixer_mutex);
+
+	for (i = 0; i < MIXER_MAX_VOICES; i++) 
+	{
+		if (mixer_voices[i].snd) Mixer_MixVoice(&mixer_voices[i], mix);
+	}
+	Mutex_Unlock(mixer_mutex);
+
+	Mixer_Output(mix, (cc_int16*)chunk->data, MIXER_CHUNK_FRAMES * 2);
+	chunk->size = MIXER_CHUNK_SIZE;
+}
+
+static cc_result Mixer_PlayLoop(struct AudioChunk* chunks) {
+	int inUse, cur = 0;
+	cc_result res;
+
+	if ((res = StreamContext_SetFormat(&sounds_ctx, 2, MIXER_SAMPLE_RATE, 100))) return res;
+	if ((res = Audio_AllocChunks(MIXER_CHUNK_SIZE, chunks, AUDIO_MAX_BUFFERS))) return res;
+	Audio_SetVolume(&sounds_ctx, 100);
+
+	while (!mixer_stopping) {
+		res = StreamContext_Update(&sounds_ctx, &inUse);
+		if (res) break;
+
+		/* Sleep until a sound is played (any queued audio will still finish playing) */
+		if (!Mixer_AnyPlaying()) {
+			Waitable_Wait(mixer_waitable); continue;
+		}
+		if (inUse >= AUDIO_MAX_BUFFERS) {
+			Thread_Sleep(10); continue;
+		}
+
+		Mixer_Mix(&chunks[cur]);
+		res = StreamContext_Enqueue(&sounds_ctx, &chunks[cur]);
+		if (res) break;
+		cur = (cur + 1) % AUDIO_MAX_BUFFERS;
+
+		/* Stream stops playing after running out of queued audio, so needs to be restarted */
+		if (!inUse && (res = StreamContext_Play(&sounds_ctx))) break;
+	}
+	return res;
+}
+
+static void Mixer_RunLoop(void) {
+	struct AudioChunk chunks[AUDIO_MAX_BUFFERS] = { 0 };
+	cc_result res = Audio_Init(&sounds_ctx, AUDIO_MAX_BUFFERS);
+	if (!res) res = Mixer_PlayLoop(chunks);
+
+	/* must close audio context before freeing chunks, as otherwise some of */
+	/*  the context's internal audio buffers may still reference the chunks */
+	Audio_Close(&sounds_ctx);
+	Audio_FreeChunks(chunks, AUDIO_MAX_BUFFERS);
+
+	if (res) {
+		Audio_Warn(res, "playing sounds");
+		Chat_AddRaw("&cDisabling sounds");
+		Audio_SoundsVolume = 0;
+	}
+
+	if (mixer_joining) return;
+	Thread_Detach(mixer_thread);
+	mixer_thread = NULL;
+}
+
+static void Mixer_Init(void) {
+	mixer_mutex    = Mutex_Create("Sound mixer");
+	mixer_waitable = Waitable_Create("Sound mixer wait");
+}
+
+static void Mixer_Free(void) {
+	Mutex_Free(mixer_mutex);
+	Waitable_Free(mixer_waitable);
+}
+
+static void Mixer_Start(void) {
+	if (mixer_thread) return;
+	mixer_joining  = false;
+	mixer_stopping = false;
+
+	Thread_Run(&mixer_thread, Mixer_RunLoop, 64 * 1024, "Sound mixer");
+}
+
+static void Mixer_Stop(void) {
+	mixer_joining  = true;
+	mixer_stopping = true;
+	Waitable_Signal(mixer_waitable);
+
+	if (mixer_thread) Thread_Join(mixer_thread);
+	mixer_thread = NULL;
+	Mem_Set(mixer_voices, 0, sizeof(mixer_voices));
+}
+
+static void Sounds_PlayData(struct AudioData* data, const struct Sound* snd, float distSq) {
+	Mixer_Play(snd, data->volume, data->rate, distSq);
+}
+#endif
+
+static void Sounds_Play(cc_uint8 type, struct Soundboard* board, float distSq) {
 	const struct Sound* snd;
 	struct AudioData data;
-	cc_result res;
 
 	if (type == SOUND_NONE || !Audio_SoundsVolume) return;
 	snd = Soundboard_PickRandom(board, type);
@@ -200,18 +498,24 @@ static void Sounds_Play(cc_uint8 type, struct Soundboard* board) {
 		data.volume /= 2;
 		if (type == SOUND_METAL) data.rate = 140;
 	}
-	
-	res = AudioPool_Play(&data);
-	if (res) Sounds_Fail(res);
+	Sounds_PlayData(&data, snd, distSq);
 }
 
 static void Audio_PlayBlockSound(void* obj, IVec3 coords, BlockID old, BlockID now) {
+	Vec3 delta;
+	float distSq;
+
+	delta.x = coords.x + 0.5f - Camera.CurrentPos.x;
+	delta.y = coords.y + 0.5f - Camera.CurrentPos.y;
+	delta.z = coords.z + 0.5f - Camera.CurrentPos.z;
+	distSq  = Vec3_LengthSquared(&delta);
+
 	if (now == BLOCK_AIR) {
-		Audio_PlayDigSound(Blocks.DigSounds[old]);
+		Sounds_Play(Blocks.DigSounds[old], &digBoard, distSq);
 	} else if (!Game_ClassicMode) {
 		/* use StepSounds instead when placing, as don't want */
 		/*  to play glass break sound when placing glass */
-		Audio_PlayDigSound(Blocks.StepSounds[now]);
+		Sounds_Play(Blocks.StepSounds[now], &digBoard, distSq);
 	}
 }
 
@@ -244,10 +548,260 @@ static cc_result Sounds_ExtractZip(const cc_string* path) {
 	return res;
 }
 
+#ifdef CC_BUILD_COOPTHREADED
+/* Backend sound contexts may directly read sound data, which therefore must be allocated by Audio_AllocChunks */
+static cc_result Sounds_Load(const cc_string* zipPath) { return Sounds_ExtractZip(zipPath); }
+#else
+/*########################################################################################################################*
+*-------------------------------------------------------Sound bank--------------------------------------------------------*
+*#########################################################################################################################*/
+/* Sounds extracted from the sounds zip are cached in a sound bank file, which stores the samples */
+/*  of all the sounds contiguously after an index. The sound bank is memory mapped when loading, */
+/*  so no per-sound allocations or parsing are needed, and multiple processes can share its pages */
+/* NOTE: Samples are stored in native endianness, as mapped data can't be endian swapped */
+static const cc_string soundbank_path    = String_FromConst("audio/sounds.bank");
+static const cc_string soundbank_tmpPath = String_FromConst("audio/sounds.bank.tmp");
+
+#define SOUNDBANK_VERSION     1
+#define SOUNDBANK_HEADER_SIZE 32
+#define SOUNDBANK_ENTRY_SIZE  16
+#define SOUNDBANK_MAX_ENTRIES (2 * SOUND_COUNT * AUDIO_MAX_SOUNDS)
+#define SOUNDBANK_TAIL_SIZE   4096
+/* Sample data of each sound is 16 byte aligned, to allow aligned SIMD loads */
+#define SoundBank_Align(offset) (((offset) + 15) & ~15U)
+
+#ifdef CC_BIG_ENDIAN
+#define SOUNDBANK_FLAGS 1
+#else
+#define SOUNDBANK_FLAGS 0
+#endif
+
+/* Identifies the contents of a sounds zip from its size, and a CRC32 of the end of the zip */
+/* NOTE: The end of the zip contains the central directory, which includes the CRC32 of every entry */
+static cc_result SoundBank_CalcKey(const cc_string* zipPath, cc_uint32* size, cc_uint32* crc) {
+	cc_uint8 tail[SOUNDBANK_TAIL_SIZE];
+	struct Stream stream;
+	cc_filepath raw_path;
+	cc_uint32 count;
+	cc_result res;
+
+	Platform_EncodePath(&raw_path, zipPath);
+	if ((res = Stream_OpenPath(&stream, &raw_path))) return res;
+
+	if (!(res = stream.Length(&stream, size))) {
+		count = min(*size, SOUNDBANK_TAIL_SIZE);
+		res   = stream.Seek(&stream, *size - count);
+		if (!res) res = Stream_Read(&stream, tail, count);
+		if (!res) *crc = Utils_CRC32(tail, count);
+	}
+
+	/* No point logging error for closing readonly file */
+	(void)stream.Close(&stream);
+	return res;
+}
+
+static struct Soundboard* SoundBank_Board(int board) {
+	return board == 0 ? &digBoard : &stepBoard;
+}
+
+/* Validates the sound bank and then sets up all the sounds to point into its data */
+static cc_bool SoundBank_Apply(cc_uint8* data, cc_uint32 size, cc_uint32 zipSize, cc_uint32 zipCrc) {
+	struct SoundGroup* group;
+	struct Sound* snd;
+	cc_uint8* entry;
+	cc_uint32 i, count, offset, len;
+	int channels, type;
+
+	if (size < SOUNDBANK_HEADER_SIZE) return false;
+	if (Mem_ReadU32_BE(data + 0) != WAV_FourCC('C','C','S','B'))       return false;
+	if (Mem_ReadU32_LE(data + 4) != SOUNDBANK_VERSION) return false;
+	if (Mem_ReadU32_LE(data + 8) != SOUNDBANK_FLAGS)   return false;
+
+	/* Sounds zip may have been changed since the sound bank was created */
+	if (Mem_ReadU32_LE(data + 12) != zipSize) return false;
+	if (Mem_ReadU32_LE(data + 16) != zipCrc)  return false;
+
+	count = Mem_ReadU32_LE(data + 20);
+	if (count > SOUNDBANK_MAX_ENTRIES) return false;
+	if (SOUNDBANK_HEADER_SIZE + count * SOUNDBANK_ENTRY_SIZE > size) return false;
+
+	for (i = 0, entry = data + SOUNDBANK_HEADER_SIZE; i < count; i++, entry += SOUNDBANK_ENTRY_SIZE) 
+	{
+		channels = Mem_ReadU16_LE(entry + 2);
+		offset   = Mem_ReadU32_LE(entry + 8);
+		len      = Mem_ReadU32_LE(entry + 12);
+
+		if (entry[0] > 1 || entry[1] >= SOUND_COUNT) return false;
+		if (channels != 1 && channels != 2)          return false;
+		if (offset > size || len > size - offset)    return false;
+		if (offset & 15)                             return false;
+	}
+
+	for (i = 0, entry = data + SOUNDBANK_HEADER_SIZE; i < count; i++, entry += SOUNDBANK_ENTRY_SIZE) 
+	{
+		type  = entry[1];
+		group = &SoundBank_Board(entry[0])->groups[type];
+		if (group->count == AUDIO_MAX_SOUNDS) continue;
+
+		snd = &group->sounds[group->count++];
+		snd->channels   = Mem_ReadU16_LE(entry + 2);
+		snd->sampleRate = Mem_ReadU32_LE(entry + 4);
+		snd->chunk.data = data + Mem_ReadU32_LE(entry + 8);
+		snd->chunk.size = Mem_ReadU32_LE(entry + 12);
+	}
+	return true;
+}
+
+/* Attempts to load all the sounds from an existing up to date sound bank */
+static cc_bool SoundBank_Load(cc_uint32 zipSize, cc_uint32 zipCrc) {
+	cc_filepath raw_path;
+	cc_uint32 size;
+	cc_file file;
+	void* data;
+	cc_result res;
+
+	Platform_EncodePath(&raw_path, &soundbank_path);
+	if (File_Open(&file, &raw_path)) return false;
+
+	res = File_Map(file, &data, &size);
+	/* No point logging error for closing readonly file */
+	(void)File_Close(file);
+	if (res) { Logger_IOWarn2(res, "mapping", &raw_path); return false; }
+
+	if (SoundBank_Apply((cc_uint8*)data, size, zipSize, zipCrc)) return true;
+	File_Unmap(data, size);
+	return false;
+}
+
+static cc_result SoundBank_WriteEntries(struct Stream* s, cc_uint32* count) {
+	cc_uint8 entry[SOUNDBANK_ENTRY_SIZE];
+	cc_uint32 offset;
+	struct Sound* snd;
+	int board, type, i;
+	cc_result res;
+
+	*count = 0;
+	/* Samples start after the header and the index of all the sounds */
+	for (board = 0; board < 2; board++) 
+		for (type = 0; type < SOUND_COUNT; type++) 
+	{
+		*count += SoundBank_Board(board)->groups[type].count;
+	}
+	offset = SoundBank_Align(SOUNDBANK_HEADER_SIZE + *count * SOUNDBANK_ENTRY_SIZE);
+
+	for (board = 0; board < 2; board++) 
+		for (type = 0; type < SOUND_COUNT; type++) 
+			for (i = 0; i < SoundBank_Board(board)->groups[type].count; i++) 
+	{
+		snd = &SoundBank_Board(board)->groups[type].sounds[i];
+		entry[0] = board;
+		entry[1] = type;
+		Mem_WriteU16_LE(entry +  2, snd->channels);
+		Mem_WriteU32_LE(entry +  4, snd->sampleRate);
+		Mem_WriteU32_LE(entry +  8, offset);
+		Mem_WriteU32_LE(entry + 12, snd->chunk.size);
+
+		if ((res = Stream_Write(s, entry, SOUNDBANK_ENTRY_SIZE))) return res;
+		offset = SoundBank_Align(offset + snd->chunk.size);
+	}
+	return 0;
+}
+
+static cc_result SoundBank_WriteSamples(struct Stream* s, cc_uint32 offset) {
+	static const cc_uint8 padding[16] = { 0 };
+	struct Sound* snd;
+	int board, type, i;
+	cc_result res;
+
+	for (board = 0; board < 2; board++) 
+		for (type = 0; type < SOUND_COUNT; type++) 
+			for (i = 0; i < SoundBank_Board(board)->groups[type].count; i++) 
+	{
+		if ((res = Stream_Write(s, padding, SoundBank_Align(offset) - offset))) return res;
+		offset = SoundBank_Align(offset);
+
+		snd = &SoundBank_Board(board)->groups[type].sounds[i];
+		if ((res = Stream_Write(s, (cc_uint8*)snd->chunk.data, snd->chunk.size))) return res;
+		offset += snd->chunk.size;
+	}
+	return 0;
+}
+
+static cc_result SoundBank_Write(struct Stream* s, cc_uint32 zipSize, cc_uint32 zipCrc) {
+	cc_uint8 header[SOUNDBANK_HEADER_SIZE] = { 0 };
+	cc_uint32 count;
+	cc_result res;
+
+	/* Header is written last, so a partially written sound bank is never considered valid */
+	if ((res = Stream_Write(s, header, SOUNDBANK_HEADER_SIZE)))   return res;
+	if ((res = SoundBank_WriteEntries(s, &count)))                return res;
+	if ((res = SoundBank_WriteSamples(s, SOUNDBANK_HEADER_SIZE + count * SOUNDBANK_ENTRY_SIZE))) return res;
+
+	Mem_WriteU32_BE(header +  0, WAV_FourCC('C','C','S','B'));
+	Mem_WriteU32_LE(header +  4, SOUNDBANK_VERSION);
+	Mem_WriteU32_LE(header +  8, SOUNDBANK_FLAGS);
+	Mem_WriteU32_LE(header + 12, zipSize);
+	Mem_WriteU32_LE(header + 16, zipCrc);
+	Mem_WriteU32_LE(header + 20, count);
+
+	if ((res = s->Seek(s, 0))) return res;
+	return Stream_Write(s, header, SOUNDBANK_HEADER_SIZE);
+}
+
+/* Creates a sound bank from all the currently loaded sounds */
+static void SoundBank_Save(cc_uint32 zipSize, cc_uint32 zipCrc) {
+	cc_filepath raw_path, raw_tmpPath;
+	struct Stream stream;
+	cc_result res, closeRes;
+
+	Platform_EncodePath(&raw_path,    &soundbank_path);
+	Platform_EncodePath(&raw_tmpPath, &soundbank_tmpPath);
+
+	res = Stream_CreatePath(&stream, &raw_tmpPath);
+	if (res) { Logger_IOWarn2(res, "creating", &raw_tmpPath); return; }
+
+	res      = SoundBank_Write(&stream, zipSize, zipCrc);
+	closeRes = stream.Close(&stream);
+	if (!res) res = closeRes;
+
+	if (res) {
+		Logger_IOWarn2(res, "writing", &raw_tmpPath);
+	} else {
+		/* Replaced by renaming, as other processes may have the existing sound bank mapped */
+		res = File_Rename(&raw_tmpPath, &raw_path);
+		if (res) Logger_IOWarn2(res, "replacing", &raw_path);
+	}
+
+	/* Don't leave a partially written sound bank behind */
+	if (res) File_Delete(&raw_tmpPath);
+}
+
+/* The sound bank is replaced by renaming, so there's no point saving it when renaming isn't supported */
+static cc_bool SoundBank_CanSave(void) {
+	cc_filepath raw_tmpPath;
+	Platform_EncodePath(&raw_tmpPath, &soundbank_tmpPath);
+	return File_Rename(&raw_tmpPath, &raw_tmpPath) != ERR_NOT_SUPPORTED;
+}
+
+static cc_result Sounds_Load(const cc_string* zipPath) {
+	cc_uint32 zipSize, zipCrc;
+	cc_result res;
+
+	res = SoundBank_CalcKey(zipPath, &zipSize, &zipCrc);
+	if (res) return Sounds_ExtractZip(zipPath);
+	if (SoundBank_Load(zipSize, zipCrc)) return 0;
+
+	res = Sounds_ExtractZip(zipPath);
+	/* Sounds loaded from the zip are kept for this session, the sound bank gets used next time */
+	if (!res && SoundBank_CanSave()) SoundBank_Save(zipSize, zipCrc);
+	return res;
+}
+#endif
+
 void Sounds_LoadDefault(void) {
-	cc_result res = Sounds_ExtractZip(&Sounds_ZipPathMC);
+	cc_result res = Sounds_Load(&Sounds_ZipPathMC);
 	if (res == ReturnCode_FileNotFound)
-		Sounds_ExtractZip(&Sounds_ZipPathCC);
+		Sounds_Load(&Sounds_ZipPathCC);
 }
 
 static cc_bool sounds_loaded;
@@ -258,22 +812,27 @@ static void Sounds_Start(void) {
 		return; 
 	}
 
+	Mixer_Start();
 	if (sounds_loaded) return;
 	sounds_loaded = true;
 	AudioBackend_LoadSounds();
 }
 
-static void Sounds_Stop(void) { AudioPool_Close(); }
+static void Sounds_Stop(void) { Mixer_Stop(); }
 
 static void Sounds_Init(void) {
 	int volume = Options_GetInt(OPT_SOUND_VOLUME, 0, 100, DEFAULT_SOUNDS_VOLUME);
+	Mixer_Init();
 	Audio_SetSounds(volume);
 	Event_Register_(&UserEvents.BlockChanged, NULL, Audio_PlayBlockSound);
 }
-static void Sounds_Free(void) { Sounds_Stop(); }
+static void Sounds_Free(void) { 
+	Sounds_Stop(); 
+	Mixer_Free();
+}
 
-void Audio_PlayDigSound(cc_uint8 type)  { Sounds_Play(type, &digBoard); }
-void Audio_PlayStepSound(cc_uint8 type) { Sounds_Play(type, &stepBoard); }
+void Audio_PlayDigSound(cc_uint8 type)  { Sounds_Play(type, &digBoard,  0.0f); }
+void Audio_PlayStepSound(cc_uint8 type) { Sounds_Play(type, &stepBoard, 0.0f); }
 #endif
 
 
@@ -75,6 +75,8 @@ cc_result Audio_AllocChunks(cc_uint32 size, struct AudioChunk* chunks, int numCh
 void Audio_FreeChunks(struct AudioChunk* chunks, int numChunks);
 
 extern struct AudioContext music_ctx;
+/* Stream context that mixed sounds are played on */
+extern struct AudioContext sounds_ctx;
 void Audio_Warn(cc_result res, const char* action);
 
 cc_result AudioPool_Play(struct AudioData* data);
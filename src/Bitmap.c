@@ -1,4 +1,9 @@
 #include "Bitmap.h"
+/* Included before Funcs.h, as C++ standard headers may undefine min/max */
+#if defined __x86_64__ || defined _M_X64 || defined _M_AMD64
+#include <emmintrin.h>
+#define PNG_USE_SSE2
+#endif
 #include "Platform.h"
 #include "ExtMath.h"
 #include "Deflate.h"
@@ -115,6 +120,21 @@ cc_bool Png_Detect(const cc_uint8* data, cc_uint32 len) {
 }
 
 
+/*########################################################################################################################*
+*---------------------------------------------------Decoded PNG stream----------------------------------------------------*
+*#########################################################################################################################*/
+static cc_result DecodedPng_Read(struct Stream* s, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	*modified = 0; return ERR_NOT_SUPPORTED;
+}
+
+void Png_MakeDecodedStream(struct Stream* stream, struct Bitmap* bmp, cc_result res) {
+	Stream_Init(stream);
+	stream->Read = DecodedPng_Read;
+	stream->meta.png.bmp    = bmp;
+	stream->meta.png.result = res;
+}
+
+
 /*########################################################################################################################*
 *------------------------------------------------------PNG decoder--------------------------------------------------------*
 *#########################################################################################################################*/
@@ -127,13 +147,198 @@ typedef void (*Png_RowExpander)(int width, BitmapCol* palette, cc_uint8* src, Bi
 
 /* 9 Filtering */
 /* 13.9 Filtering */
+/* NOTE: SSE2 is always available on x86-64, so no runtime detection is needed */
+#ifdef PNG_USE_SSE2
+/* NOTE: Compilers merge these into a single 32 bit load/store */
+static CC_INLINE __m128i Png_Load4(const cc_uint8* p) {
+	return _mm_cvtsi32_si128((int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((cc_uint32)p[3] << 24)));
+}
+
+static CC_INLINE void Png_Store4(cc_uint8* p, __m128i value) {
+	cc_uint32 v = (cc_uint32)_mm_cvtsi128_si32(value);
+	p[0] = (cc_uint8)v; p[1] = (cc_uint8)(v >> 8); p[2] = (cc_uint8)(v >> 16); p[3] = (cc_uint8)(v >> 24);
+}
+
+/* Reconstructs 16 bytes at a time, returns number of bytes reconstructed */
+static cc_uint32 Png_ReconstructUp_SSE2(cc_uint8* line, cc_uint8* prior, cc_uint32 lineLen) {
+	cc_uint32 i;
+	for (i = 0; i + 16 <= lineLen; i += 16)
+	{
+		__m128i x = _mm_loadu_si128((__m128i*)(line  + i));
+		__m128i b = _mm_loadu_si128((__m128i*)(prior + i));
+		_mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(x, b));
+	}
+	return i;
+}
+
+/* Reconstructs 4 pixels at a time, using a prefix sum within each group of 4 pixels */
+static cc_uint32 Png_ReconstructSub4_SSE2(cc_uint8* line, cc_uint32 lineLen) {
+	__m128i a = _mm_setzero_si128();
+	cc_uint32 i;
+
+	for (i = 0; i + 16 <= lineLen; i += 16)
+	{
+		__m128i x = _mm_loadu_si128((__m128i*)(line + i));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi8(x, a);
+
+		_mm_storeu_si128((__m128i*)(line + i), x);
+		a = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3)); /* last pixel to all lanes */
+	}
+	return i;
+}
+
+/* Each pixel depends on the previous pixel, so only the 4 bytes of a pixel are done in parallel */
+static void Png_ReconstructAverage4_SSE2(cc_uint8* line, cc_uint8* prior, cc_uint32 lineLen) {
+	__m128i a = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+	cc_uint32 i;
+
+	for (i = 0; i < lineLen; i += 4)
+	{
+		__m128i b = Png_Load4(prior + i);
+		/* _mm_avg_epu8 rounds up, so subtract 1 when (a + b) is odd */
+		__m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+
+		a = _mm_add_epi8(Png_Load4(line + i), avg);
+		Png_Store4(line + i, a);
+	}
+}
+
+static CC_INLINE __m128i Png_Abs16(__m128i x) {
+	return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+/* Bitwise select of (mask ? a : b) */
+#define Png_Select(mask, a, b) _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b))
+
+static void Png_ReconstructPaeth4_SSE2(cc_uint8* line, cc_uint8* prior, cc_uint32 lineLen) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i a = zero, c = zero; /* Pixels left and upper left, as 16 bit lanes */
+	cc_uint32 i;
+
+	for (i = 0; i < lineLen; i += 4)
+	{
+		__m128i b = _mm_unpacklo_epi8(Png_Load4(prior + i), zero);
+		__m128i x = _mm_unpacklo_epi8(Png_Load4(line  + i), zero);
+		/* p = a + b - c, so (p - a) = (b - c) and (p - b) = (a - c) */
+		__m128i pa = _mm_sub_epi16(b, c);
+		__m128i pb = _mm_sub_epi16(a, c);
+		__m128i pc = _mm_add_epi16(pa, pb);
+		__m128i smallest, nearest;
+
+		pa = Png_Abs16(pa); pb = Png_Abs16(pb); pc = Png_Abs16(pc);
+		smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+		/* Ties are broken in the order a, b, c */
+		nearest = Png_Select(_mm_cmpeq_epi16(pb, smallest), b, c);
+		nearest = Png_Select(_mm_cmpeq_epi16(pa, smallest), a, nearest);
+
+		a = _mm_and_si128(_mm_add_epi16(x, nearest), _mm_set1_epi16(0xFF));
+		c = b;
+		Png_Store4(line + i, _mm_packus_epi16(a, a));
+	}
+}
+#endif
+
+#if defined PNG_USE_SSE2 && !defined BITMAP_16BPP
+/* Combines R, G, B, A 32 bit lanes of 4 pixels into BitmapCols */
+#define Png_Pack4(r, g, b, a) _mm_or_si128( \
+	_mm_or_si128(_mm_slli_epi32(r, BITMAPCOLOR_R_SHIFT), _mm_slli_epi32(g, BITMAPCOLOR_G_SHIFT)), \
+	_mm_or_si128(_mm_slli_epi32(b, BITMAPCOLOR_B_SHIFT), _mm_slli_epi32(a, BITMAPCOLOR_A_SHIFT)))
+
+/* NOTE: Expanders that process backwards expand pixels [start, end), and return start */
+static int Png_ExpandGray_SSE2(int end, cc_uint8* src, BitmapCol* dst) {
+	__m128i alpha = _mm_set1_epi32((int)BITMAPCOLOR_A_MASK);
+	int i;
+
+	for (i = end - 16; i >= 0; i -= 16)
+	{
+		__m128i x  = _mm_loadu_si128((__m128i*)(src + i));
+		__m128i lo = _mm_unpacklo_epi8(x, x);
+		__m128i hi = _mm_unpackhi_epi8(x, x);
+		/* Gray value in all 4 bytes of each pixel, then alpha byte set to 255 */
+		_mm_storeu_si128((__m128i*)(dst + i),      _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+		_mm_storeu_si128((__m128i*)(dst + i + 4),  _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+		_mm_storeu_si128((__m128i*)(dst + i + 8),  _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+		_mm_storeu_si128((__m128i*)(dst + i + 12), _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+	}
+	return i + 16;
+}
+
+static int Png_ExpandGrayA_SSE2(int end, cc_uint8* src, BitmapCol* dst) {
+	__m128i zero = _mm_setzero_si128(), mask = _mm_set1_epi32(0xFF);
+	int i;
+
+	for (i = end - 8; i >= 0; i -= 8)
+	{
+		__m128i x  = _mm_loadu_si128((__m128i*)(src + i * 2));
+		__m128i lo = _mm_unpacklo_epi16(x, zero);
+		__m128i hi = _mm_unpackhi_epi16(x, zero);
+		__m128i g0 = _mm_and_si128(lo, mask), a0 = _mm_srli_epi32(lo, 8);
+		__m128i g1 = _mm_and_si128(hi, mask), a1 = _mm_srli_epi32(hi, 8);
+
+		_mm_storeu_si128((__m128i*)(dst + i),     Png_Pack4(g0, g0, g0, a0));
+		_mm_storeu_si128((__m128i*)(dst + i + 4), Png_Pack4(g1, g1, g1, a1));
+	}
+	return i + 8;
+}
+
+/* NOTE: Reads 4 bytes past the last expanded pixel */
+static int Png_ExpandRGB_SSE2(int end, cc_uint8* src, BitmapCol* dst) {
+	__m128i mask = _mm_set1_epi32(0xFF);
+	int i;
+
+	for (i = end - 4; i >= 0; i -= 4)
+	{
+		__m128i x = _mm_loadu_si128((__m128i*)(src + i * 3));
+		/* Move each 3 byte pixel into its own 32 bit lane */
+		__m128i p01 = _mm_unpacklo_epi32(x,                    _mm_srli_si128(x, 3));
+		__m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(x, 6), _mm_srli_si128(x, 9));
+		__m128i p   = _mm_unpacklo_epi64(p01, p23);
+
+		__m128i r = _mm_and_si128(p, mask);
+		__m128i g = _mm_and_si128(_mm_srli_epi32(p,  8), mask);
+		__m128i b = _mm_and_si128(_mm_srli_epi32(p, 16), mask);
+		_mm_storeu_si128((__m128i*)(dst + i), Png_Pack4(r, g, b, mask));
+	}
+	return i + 4;
+}
+
+/* Processed forwards, returns number of pixels expanded */
+static int Png_ExpandRGBA_SSE2(int width, cc_uint8* src, BitmapCol* dst) {
+	__m128i mask = _mm_set1_epi32(0xFF);
+	int i;
+
+	for (i = 0; i + 4 <= width; i += 4)
+	{
+		__m128i x = _mm_loadu_si128((__m128i*)(src + i * 4));
+		__m128i r = _mm_and_si128(x, mask);
+		__m128i g = _mm_and_si128(_mm_srli_epi32(x,  8), mask);
+		__m128i b = _mm_and_si128(_mm_srli_epi32(x, 16), mask);
+		__m128i a = _mm_srli_epi32(x, 24);
+		_mm_storeu_si128((__m128i*)(dst + i), Png_Pack4(r, g, b, a));
+	}
+	return i;
+}
+#define PNG_EXPAND_SSE2
+#endif
+
 static void Png_ReconstructFirst(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* line, cc_uint32 lineLen) {
 	/* First scanline is a special case, where all values in prior array are 0 */
 	cc_uint32 i, j;
 
 	switch (type) {
 	case PNG_FILTER_SUB:
-		for (i = bytesPerPixel, j = 0; i < lineLen; i++, j++) {
+	case PNG_FILTER_PAETH:
+		/* Paeth with prior of 0 always picks left pixel, so is same as Sub */
+		i = bytesPerPixel;
+#ifdef PNG_USE_SSE2
+		/* NOTE: SIMD version handles first pixel too, as it adds 0 to it */
+		if (bytesPerPixel == 4) i = Png_ReconstructSub4_SSE2(line, lineLen);
+		if (i < bytesPerPixel)  i = bytesPerPixel;
+#endif
+		for (j = i - bytesPerPixel; i < lineLen; i++, j++) {
 			line[i] += line[j];
 		}
 		return;
@@ -143,12 +348,6 @@ static void Png_ReconstructFirst(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8
 			line[i] += (line[j] >> 1);
 		}
 		return;
-
-	case PNG_FILTER_PAETH:
-		for (i = bytesPerPixel, j = 0; i < lineLen; i++, j++) {
-			line[i] += line[j];
-		}
-		return;
 	}
 }
 
@@ -157,18 +356,31 @@ static void Png_Reconstruct(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* lin
 
 	switch (type) {
 	case PNG_FILTER_SUB:
-		for (i = bytesPerPixel, j = 0; i < lineLen; i++, j++) {
+		i = bytesPerPixel;
+#ifdef PNG_USE_SSE2
+		/* NOTE: SIMD version handles first pixel too, as it adds 0 to it */
+		if (bytesPerPixel == 4) i = Png_ReconstructSub4_SSE2(line, lineLen);
+		if (i < bytesPerPixel)  i = bytesPerPixel;
+#endif
+		for (j = i - bytesPerPixel; i < lineLen; i++, j++) {
 			line[i] += line[j];
 		}
 		return;
 
 	case PNG_FILTER_UP:
-		for (i = 0; i < lineLen; i++) {
+		i = 0;
+#ifdef PNG_USE_SSE2
+		i = Png_ReconstructUp_SSE2(line, prior, lineLen);
+#endif
+		for (; i < lineLen; i++) {
 			line[i] += prior[i];
 		}
 		return;
 
 	case PNG_FILTER_AVERAGE:
+#ifdef PNG_USE_SSE2
+		if (bytesPerPixel == 4) { Png_ReconstructAverage4_SSE2(line, prior, lineLen); return; }
+#endif
 		for (i = 0; i < bytesPerPixel; i++) {
 			line[i] += (prior[i] >> 1);
 		}
@@ -178,6 +390,9 @@ static void Png_Reconstruct(cc_uint8 type, cc_uint8 bytesPerPixel, cc_uint8* lin
 		return;
 
 	case PNG_FILTER_PAETH:
+#ifdef PNG_USE_SSE2
+		if (bytesPerPixel == 4) { Png_ReconstructPaeth4_SSE2(line, prior, lineLen); return; }
+#endif
 		/* TODO: verify this is right */
 		for (i = 0; i < bytesPerPixel; i++) {
 			line[i] += prior[i];
@@ -231,6 +446,9 @@ static void Png_Expand_GRAYSCALE_4(int width, BitmapCol* palette, cc_uint8* src,
 
 static void Png_Expand_GRAYSCALE_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
 	cc_uint8 rgb;
+#ifdef PNG_EXPAND_SSE2
+	width = Png_ExpandGray_SSE2(width, src, dst);
+#endif
 	src += (width - 1);
 	dst += (width - 1);
 
@@ -242,6 +460,13 @@ static void Png_Expand_GRAYSCALE_8(int width, BitmapCol* palette, cc_uint8* src,
 }
 
 static void Png_Expand_RGB_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
+#ifdef PNG_EXPAND_SSE2
+	/* SIMD expansion reads past the last pixel, so the last 2 pixels are expanded normally first */
+	if (width > 2) {
+		Png_Expand_RGB_8(2, palette, src + (width - 2) * 3, dst + (width - 2));
+		width = Png_ExpandRGB_SSE2(width - 2, src, dst);
+	}
+#endif
 	src += (width - 1) * 3;
 	dst += (width - 1);
 
@@ -280,6 +505,9 @@ static void Png_Expand_INDEXED_8(int width, BitmapCol* palette, cc_uint8* src, B
 
 static void Png_Expand_GRAYSCALE_A_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
 	cc_uint8 rgb;
+#ifdef PNG_EXPAND_SSE2
+	width = Png_ExpandGrayA_SSE2(width, src, dst);
+#endif
 	src += (width - 1) * 2;
 	dst += (width - 1);
 
@@ -292,6 +520,10 @@ static void Png_Expand_GRAYSCALE_A_8(int width, BitmapCol* palette, cc_uint8* sr
 
 static void Png_Expand_RGB_A_8(int width, BitmapCol* palette, cc_uint8* src, BitmapCol* dst) {
 	/* Processed in forward order */
+#ifdef PNG_EXPAND_SSE2
+	int i = Png_ExpandRGBA_SSE2(width, src, dst);
+	src += i * 4; dst += i; width -= i;
+#endif
 
 	for (; width >= 4; width -= 4) {
 		PNG_Do_RGB_A__8(); PNG_Do_RGB_A__8();
@@ -374,6 +606,18 @@ static CC_NOINLINE cc_result DecodeFailure(struct Bitmap* bmp, cc_result res) {
 	return res;	
 }
 
+/* Moves an image previously decoded by Png_Decode out of a decoded PNG stream */
+static cc_result DecodedPng_Take(struct Bitmap* bmp, struct Stream* stream) {
+	struct Bitmap* src = stream->meta.png.bmp;
+	cc_result res      = stream->meta.png.result;
+
+	*bmp = *src;
+	src->scan0 = NULL;
+	/* Image has been moved out, so behave like an exhausted stream afterwards */
+	stream->meta.png.result = ERR_END_OF_STREAM;
+	return res;
+}
+
 cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream) {
 	cc_uint8 tmp[64];
 	cc_uint32 dataSize, fourCC;
@@ -409,6 +653,9 @@ cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream) {
 	int zlib_state = ZLIB_STATE_COMPRESSION_METHOD;
 	cc_uint8* data = NULL;
 
+	/* Image may have already been decoded on another thread */
+	if (stream->Read == DecodedPng_Read) return DecodedPng_Take(bmp, stream);
+
 	bmp->width  = 0; 
 	bmp->height = 0;
 	bmp->scan0  = NULL;
@@ -139,6 +139,10 @@ typedef BitmapCol* (*Png_RowGetter)(struct Bitmap* bmp, int row, void* ctx);
      https://github.com/nothings/stb/blob/master/stb_image.h
 */
 CC_API cc_result Png_Decode(struct Bitmap* bmp, struct Stream* stream);
+/* Wraps an already decoded PNG image (e.g. one decoded on another thread). */
+/* Png_Decode on this stream then just moves the image (or the error from decoding it) into the bitmap. */
+/* NOTE: The image can only be moved out once, and all other stream operations fail */
+void Png_MakeDecodedStream(struct Stream* stream, struct Bitmap* bmp, cc_result res);
 /* Encodes a bitmap in PNG format. */
 /* getRow is optional. Can be used to modify how rows are encoded. (e.g. flip image) */
 /* if alpha is non-zero, RGBA channels are saved, otherwise only RGB channels are. */
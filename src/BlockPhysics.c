@@ -87,22 +87,147 @@ static cc_uint32 TickQueue_Dequeue(struct TickQueue* queue) {
 }
 
 
+/* Timing wheel of queues, where each slot holds the liquid tick entries due on the same tick. */
+/* NOTE: Avoids having to dequeue and requeue every single entry each tick just to decrement its delay */
+#define TICKWHEEL_SLOTS 32 /* Must be a power of two, and greater than longest delay + 1 */
+struct TickWheel {
+	struct TickQueue slots[TICKWHEEL_SLOTS];
+	int cur; /* Slot of the most recently processed tick */
+};
+
+static void TickWheel_Init(struct TickWheel* wheel) {
+	int i;
+	for (i = 0; i < TICKWHEEL_SLOTS; i++) TickQueue_Init(&wheel->slots[i]);
+	wheel->cur = 0;
+}
+
+static void TickWheel_Clear(struct TickWheel* wheel) {
+	int i;
+	for (i = 0; i < TICKWHEEL_SLOTS; i++) TickQueue_Clear(&wheel->slots[i]);
+	wheel->cur = 0;
+}
+
+/* Schedules an entry to be processed after the given number of ticks. */
+/* NOTE: Entries scheduled while the wheel is being processed are delayed by one more tick */
+static void TickWheel_Schedule(struct TickWheel* wheel, cc_uint32 item, int delay) {
+	int slot = (wheel->cur + delay + 1) & (TICKWHEEL_SLOTS - 1);
+	TickQueue_Enqueue(&wheel->slots[slot], item);
+}
+
+/* Advances to the next tick, returning the queue of entries due on that tick. */
+static struct TickQueue* TickWheel_Advance(struct TickWheel* wheel) {
+	wheel->cur = (wheel->cur + 1) & (TICKWHEEL_SLOTS - 1);
+	return &wheel->slots[wheel->cur];
+}
+
+
 struct Physics_ Physics;
 static RNGState physics_rnd;
 static int physics_tickCount;
 static int physics_maxWaterX, physics_maxWaterY, physics_maxWaterZ;
-static struct TickQueue lavaQ, waterQ;
+static struct TickWheel lavaQ, waterQ;
+
+#define PHYSICS_ONE_DELAY   1
+#define PHYSICS_LAVA_DELAY  30
+#define PHYSICS_WATER_DELAY 5
+
+/* Number of sponges in each chunk, used to skip checking for nearby sponges block by block */
+static cc_uint16* physics_sponges;
+/* Number of blocks with a random tick handler in each chunk */
+static cc_uint16* physics_tickables;
+/* Total number of blocks with a random tick handler in each Y layer of chunks */
+static int* physics_tickableLayers;
+/* NOTE: Only the lower 8 bits of block IDs are checked, so counts may be higher than actual number of blocks */
+
+#define Physics_IsSponge(block)   ((BlockRaw)(block) == BLOCK_SPONGE)
+#define Physics_IsTickable(block) (Physics.OnRandomTick[(BlockRaw)(block)] != NULL)
+
+static void Physics_FreeCounts(void) {
+	Mem_Free(physics_sponges);
+	Mem_Free(physics_tickables);
+	Mem_Free(physics_tickableLayers);
+
+	physics_sponges        = NULL;
+	physics_tickables      = NULL;
+	physics_tickableLayers = NULL;
+}
+
+static void Physics_CountAll(void) {
+	int x, y, z, cIndex, index = 0;
+	BlockRaw block;
+	Physics_FreeCounts();
+	if (!World.Blocks) return;
+
+	physics_sponges        = (cc_uint16*)Mem_TryAllocCleared(World.ChunksCount, 2);
+	physics_tickables      = (cc_uint16*)Mem_TryAllocCleared(World.ChunksCount, 2);
+	physics_tickableLayers = (int*)Mem_TryAllocCleared(World.ChunksY, 4);
+
+	/* Not a problem if out of memory, just falls back to checking block by block */
+	if (!physics_sponges || !physics_tickables || !physics_tickableLayers) {
+		Physics_FreeCounts(); return;
+	}
+
+	for (y = 0; y < World.Height; y++)
+		for (z = 0; z < World.Length; z++)
+	{
+		cIndex = World_ChunkPack(0, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+
+		for (x = 0; x < World.Width; x++, index++) {
+			block = World.Blocks[index];
+			if (Physics_IsSponge(block)) physics_sponges[cIndex + (x >> CHUNK_SHIFT)]++;
+
+			if (!Physics_IsTickable(block)) continue;
+			physics_tickables[cIndex + (x >> CHUNK_SHIFT)]++;
+			physics_tickableLayers[y >> CHUNK_SHIFT]++;
+		}
+	}
+}
+
+void Physics_TrackBlock(int x, int y, int z, BlockID old, BlockID now) {
+	int cy = y >> CHUNK_SHIFT, index;
+	if (!physics_sponges || old == now) return;
+	index = World_ChunkPack(x >> CHUNK_SHIFT, cy, z >> CHUNK_SHIFT);
+
+	if (Physics_IsSponge(old)) physics_sponges[index]--;
+	if (Physics_IsSponge(now)) physics_sponges[index]++;
+
+	if (Physics_IsTickable(old)) {
+		physics_tickables[index]--; physics_tickableLayers[cy]--;
+	}
+	if (Physics_IsTickable(now)) {
+		physics_tickables[index]++; physics_tickableLayers[cy]++;
+	}
+}
+
+/* Whether any chunks overlapping the given region might contain sponges */
+static cc_bool Physics_MaybeSponges(int x1, int y1, int z1, int x2, int y2, int z2) {
+	int cx, cy, cz;
+	if (!physics_sponges) return true;
 
-#define PHYSICS_DELAY_MASK 0xF8000000UL
-#define PHYSICS_POS_MASK   0x07FFFFFFUL
-#define PHYSICS_DELAY_SHIFT 27
-#define PHYSICS_ONE_DELAY   (1U << PHYSICS_DELAY_SHIFT)
-#define PHYSICS_LAVA_DELAY (30U << PHYSICS_DELAY_SHIFT)
-#define PHYSICS_WATER_DELAY (5U << PHYSICS_DELAY_SHIFT)
+	for (cy = y1 >> CHUNK_SHIFT; cy <= (y2 >> CHUNK_SHIFT); cy++)
+		for (cz = z1 >> CHUNK_SHIFT; cz <= (z2 >> CHUNK_SHIFT); cz++)
+			for (cx = x1 >> CHUNK_SHIFT; cx <= (x2 >> CHUNK_SHIFT); cx++)
+	{
+		if (physics_sponges[World_ChunkPack(cx, cy, cz)]) return true;
+	}
+	return false;
+}
+
+/* Whether any chunks in the given Y layer of chunks might contain blocks with a random tick handler */
+static cc_bool Physics_MaybeTickables(int cy) {
+	if (!physics_tickables) return true;
+	return physics_tickableLayers[cy] > 0;
+}
+
+static void Physics_OnNewMap(void* obj) {
+	/* Counts are for the old map's dimensions, and are rebuilt once the new map is loaded */
+	Physics_FreeCounts();
+}
 
 static void Physics_OnNewMapLoaded(void* obj) {
-	TickQueue_Clear(&lavaQ);
-	TickQueue_Clear(&waterQ);
+	TickWheel_Clear(&lavaQ);
+	TickWheel_Clear(&waterQ);
+	Physics_CountAll();
 
 	physics_maxWaterX = World.MaxX - 2;
 	physics_maxWaterY = World.MaxY - 2;
@@ -170,6 +295,11 @@ static void Physics_TickRandomBlocks(void) {
 	int x, y, z, x2, y2, z2;
 
 	for (y = 0; y < World.Height; y += CHUNK_SIZE) {
+		/* Random ticks for a chunk pick from every index between its min and max corners, */
+		/*  which covers most of the Y layer of chunks. So only entire layers are skipped, */
+		/*  as otherwise the chance of a block being randomly ticked would change */
+		if (!Physics_MaybeTickables(y >> CHUNK_SHIFT)) continue;
+
 		y2 = min(y + CHUNK_MAX, World.MaxY);
 		for (z = 0; z < World.Length; z += CHUNK_SIZE) {
 			z2 = min(z + CHUNK_MAX, World.MaxZ);
@@ -225,18 +355,6 @@ static void Physics_DoFalling(int index, BlockID block) {
 	Physics_ActivateNeighbours(x, y, z, start);
 }
 
-static cc_bool Physics_CheckItem(struct TickQueue* queue, int* posIndex) {
-	cc_uint32 item = TickQueue_Dequeue(queue);
-	*posIndex     = (int)(item & PHYSICS_POS_MASK);
-
-	if (item >= PHYSICS_ONE_DELAY) {
-		item -= PHYSICS_ONE_DELAY;
-		TickQueue_Enqueue(queue, item);
-		return false;
-	}
-	return true;
-}
-
 
 static void Physics_HandleSapling(int index, BlockID block) {
 	IVec3 coords[TREE_MAX_COUNT];
@@ -326,7 +444,7 @@ static void Physics_HandleMushroom(int index, BlockID block) {
 
 
 static void Physics_PlaceLava(int index, BlockID block) {
-	TickQueue_Enqueue(&lavaQ, PHYSICS_LAVA_DELAY | index);
+	TickWheel_Schedule(&lavaQ, index, PHYSICS_LAVA_DELAY);
 }
 
 static void Physics_PropagateLava(int posIndex, int x, int y, int z) {
@@ -338,7 +456,7 @@ static void Physics_PropagateLava(int posIndex, int x, int y, int z) {
 			Game_UpdateBlock(x, y, z, BLOCK_STONE);
 		}
 	} else if (Blocks.Draw[block] == DRAW_GAS) {
-		TickQueue_Enqueue(&lavaQ, PHYSICS_LAVA_DELAY | posIndex);
+		TickWheel_Schedule(&lavaQ, posIndex, PHYSICS_LAVA_DELAY);
 		Game_UpdateBlock(x, y, z, BLOCK_LAVA);
 	}
 }
@@ -355,25 +473,40 @@ static void Physics_ActivateLava(int index, BlockID block) {
 }
 
 static void Physics_TickLava(void) {
-	int i, count = lavaQ.count;
-	for (i = 0; i < count; i++) {
-		int index;
-		if (Physics_CheckItem(&lavaQ, &index)) {
-			BlockID block = World.Blocks[index];
-			if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
-			Physics_ActivateLava(index, block);
-		}
+	struct TickQueue* due = TickWheel_Advance(&lavaQ);
+	while (due->count) {
+		int index     = (int)TickQueue_Dequeue(due);
+		BlockID block = World.Blocks[index];
+		if (!(block == BLOCK_LAVA || block == BLOCK_STILL_LAVA)) continue;
+		Physics_ActivateLava(index, block);
 	}
 }
 
 
 static void Physics_PlaceWater(int index, BlockID block) {
-	TickQueue_Enqueue(&waterQ, PHYSICS_WATER_DELAY | index);
+	TickWheel_Schedule(&waterQ, index, PHYSICS_WATER_DELAY);
+}
+
+static cc_bool Physics_HasNearbySponge(int x, int y, int z) {
+	int x1 = x < 2 ? 0 : x - 2, x2 = x > physics_maxWaterX ? World.MaxX : x + 2;
+	int y1 = y < 2 ? 0 : y - 2, y2 = y > physics_maxWaterY ? World.MaxY : y + 2;
+	int z1 = z < 2 ? 0 : z - 2, z2 = z > physics_maxWaterZ ? World.MaxZ : z + 2;
+	int xx, yy, zz;
+
+	if (!Physics_MaybeSponges(x1, y1, z1, x2, y2, z2)) return false;
+
+	for (yy = y1; yy <= y2; yy++) {
+		for (zz = z1; zz <= z2; zz++) {
+			for (xx = x1; xx <= x2; xx++) {
+				if (World_GetBlock(xx, yy, zz) == BLOCK_SPONGE) return true;
+			}
+		}
+	}
+	return false;
 }
 
 static void Physics_PropagateWater(int posIndex, int x, int y, int z) {
 	BlockID block = World.Blocks[posIndex];
-	int xx, yy, zz;
 
 	if (block >= BLOCK_WATER && block <= BLOCK_STILL_LAVA) {
 		/* Water spreading into lava turns the lava solid */
@@ -381,17 +514,9 @@ static void Physics_PropagateWater(int posIndex, int x, int y, int z) {
 			Game_UpdateBlock(x, y, z, BLOCK_STONE);
 		}
 	} else if (Blocks.Draw[block] == DRAW_GAS) {
-		/* Sponge check */		
-		for (yy = (y < 2 ? 0 : y - 2); yy <= (y > physics_maxWaterY ? World.MaxY : y + 2); yy++) {
-			for (zz = (z < 2 ? 0 : z - 2); zz <= (z > physics_maxWaterZ ? World.MaxZ : z + 2); zz++) {
-				for (xx = (x < 2 ? 0 : x - 2); xx <= (x > physics_maxWaterX ? World.MaxX : x + 2); xx++) {
-					block = World_GetBlock(xx, yy, zz);
-					if (block == BLOCK_SPONGE) return;
-				}
-			}
-		}
+		if (Physics_HasNearbySponge(x, y, z)) return;
 
-		TickQueue_Enqueue(&waterQ, PHYSICS_WATER_DELAY | posIndex);
+		TickWheel_Schedule(&waterQ, posIndex, PHYSICS_WATER_DELAY);
 		Game_UpdateBlock(x, y, z, BLOCK_WATER);
 	}
 }
@@ -408,14 +533,12 @@ static void Physics_ActivateWater(int index, BlockID block) {
 }
 
 static void Physics_TickWater(void) {
-	int i, count = waterQ.count;
-	for (i = 0; i < count; i++) {
-		int index;
-		if (Physics_CheckItem(&waterQ, &index)) {
-			BlockID block = World.Blocks[index];
-			if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
-			Physics_ActivateWater(index, block);
-		}
+	struct TickQueue* due = TickWheel_Advance(&waterQ);
+	while (due->count) {
+		int index     = (int)TickQueue_Dequeue(due);
+		BlockID block = World.Blocks[index];
+		if (!(block == BLOCK_WATER || block == BLOCK_STILL_WATER)) continue;
+		Physics_ActivateWater(index, block);
 	}
 }
 
@@ -451,7 +574,7 @@ static void Physics_DeleteSponge(int index, BlockID block) {
 					index = World_Pack(xx, yy, zz);
 					block = World.Blocks[index];
 					if (block == BLOCK_WATER || block == BLOCK_STILL_WATER) {
-						TickQueue_Enqueue(&waterQ, index | PHYSICS_ONE_DELAY);
+						TickWheel_Schedule(&waterQ, index, PHYSICS_ONE_DELAY);
 					}
 				}
 			}
@@ -519,10 +642,11 @@ static void Physics_HandleTnt(int index, BlockID block) {
 }
 
 void Physics_Init(void) {
+	Event_Register_(&WorldEvents.NewMap,       NULL, Physics_OnNewMap);
 	Event_Register_(&WorldEvents.MapLoaded,    NULL, Physics_OnNewMapLoaded);
 	Physics.Enabled = Options_GetBool(OPT_BLOCK_PHYSICS, true);
-	TickQueue_Init(&lavaQ);
-	TickQueue_Init(&waterQ);
+	TickWheel_Init(&lavaQ);
+	TickWheel_Init(&waterQ);
 
 	Physics.OnPlace[BLOCK_SAND]        = Physics_DoFalling;
 	Physics.OnPlace[BLOCK_GRAVEL]      = Physics_DoFalling;
@@ -562,7 +686,9 @@ void Physics_Init(void) {
 }
 
 void Physics_Free(void) {
+	Event_Unregister_(&WorldEvents.NewMap,       NULL, Physics_OnNewMap);
 	Event_Unregister_(&WorldEvents.MapLoaded,    NULL, Physics_OnNewMapLoaded);
+	Physics_FreeCounts();
 }
 
 void Physics_Tick(void) {
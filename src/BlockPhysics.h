@@ -25,6 +25,9 @@ CC_VAR extern struct Physics_ {
 
 void Physics_SetEnabled(cc_bool enabled);
 void Physics_OnBlockChanged(int x, int y, int z, BlockID old, BlockID now);
+/* Updates per chunk counts of blocks that physics checks for (e.g. sponges), after a block has changed. */
+/* NOTE: Must be called for every block change, not just changes that physics is notified of. */
+void Physics_TrackBlock(int x, int y, int z, BlockID old, BlockID now);
 void Physics_Init(void);
 void Physics_Free(void);
 void Physics_Tick(void);
@@ -121,6 +121,15 @@ void Inflate_Process(struct InflateState* s) {
 void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, struct Stream* underlying) {
 	Process_Abort("Should never be called");
 }
+
+void Inflate_SetInput(struct InflateState* state, cc_uint8* data, cc_uint32 count) {
+	Process_Abort("Should never be called");
+}
+
+cc_result Inflate_Decompress(struct InflateState* state, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	Process_Abort("Should never be called");
+	return 0;
+}
 #else
 enum INFLATE_STATE_ {
 	INFLATE_STATE_HEADER, INFLATE_STATE_UNCOMPRESSED_HEADER,
@@ -768,6 +777,20 @@ void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, stru
 	stream->meta.inflate = state;
 	stream->Read = Inflate_StreamRead;
 }
+
+void Inflate_SetInput(struct InflateState* state, cc_uint8* data, cc_uint32 count) {
+	state->NextIn  = data;
+	state->AvailIn = count;
+}
+
+cc_result Inflate_Decompress(struct InflateState* state, cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	state->Output   = data;
+	state->AvailOut = count;
+
+	Inflate_Process(state);
+	*modified = count - state->AvailOut;
+	return state->State == INFLATE_STATE_DONE ? state->result : 0;
+}
 #endif
 
 
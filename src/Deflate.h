@@ -78,6 +78,13 @@ void Inflate_Process(struct InflateState* s);
 /* NOTE: This only uncompresses pure DEFLATE compressed data. */
 /* If data starts with a GZIP or ZLIB header, use GZipHeader_Read or ZLibHeader_Read to first skip it. */
 CC_API void Inflate_MakeStream2(struct Stream* stream, struct InflateState* state, struct Stream* underlying);
+/* Sets the compressed data that Inflate_Decompress reads from. */
+/* NOTE: The data is read directly rather than first copied into Input, */
+/*  so must remain valid until it has been entirely consumed by Inflate_Decompress */
+CC_API void Inflate_SetInput(struct InflateState* state, cc_uint8* data, cc_uint32 count);
+/* Decompresses as much of the current input data as possible, up to 'count' bytes of output. */
+/* NOTE: Once all input has been consumed, call Inflate_SetInput with more data to continue. */
+CC_API cc_result Inflate_Decompress(struct InflateState* state, cc_uint8* data, cc_uint32 count, cc_uint32* modified);
 
 
 #define DEFLATE_BLOCK_SIZE  16384
@@ -44,13 +44,17 @@ void Entity_Init(struct Entity* e) {
 	e->uScale     = 1.0f;
 	e->vScale     = 1.0f;
 	e->PushStrength = 1.0f;
-	e->_skinReqID = 0;
+	e->_skinID    = 0;
 	e->SkinRaw[0] = '\0';
 	e->NameRaw[0] = '\0';
 	Entity_SetModel(e, &model);
 }
 
 void Entity_SetName(struct Entity* e, const cc_string* name) {
+	cc_string cur = String_FromRawArray(e->NameRaw);
+	/* Avoid needlessly redrawing the name texture */
+	if (String_Equals(&cur, name)) return;
+
 	EntityNames_Delete(e);
 	String_CopyToRawArray(e->NameRaw, name);
 }
@@ -207,12 +211,95 @@ cc_bool Entity_TouchesAnyWater(struct Entity* e) {
 /*########################################################################################################################*
 *------------------------------------------------------Entity skins-------------------------------------------------------*
 *#########################################################################################################################*/
-/* Copies skin data from another entity */
-static void Entity_CopySkin(struct Entity* dst, struct Entity* src) {
-	dst->TextureId	= src->TextureId;	
-	dst->SkinType	= src->SkinType;
-	dst->uScale		= src->uScale;
-	dst->vScale		= src->vScale;
+/* Skins are shared by all entities using the same skin name, and only freed once no entity uses them anymore */
+/* NOTE: Each entity uses at most one skin, so there can't be more than ENTITIES_MAX_COUNT skins at once */
+#define SKINS_HASH_BUCKETS 64
+
+static struct Skin {
+	char name[STRING_SIZE];
+	int refCount;          /* Number of entities using this skin, 0 if unused */
+	int reqID;             /* ID of the request downloading this skin, 0 if not downloading */
+	int next;              /* Index of next skin with the same hash plus one, 0 if none */
+	cc_bool completed;     /* Whether skin has finished downloading (texID may still be 0 if it failed) */
+	cc_bool clearHat;      /* Whether to clear the hat area if it's completely opaque */
+	cc_uint8 skinType;
+	GfxResourceID texID;
+	float uScale, vScale;
+} skins[ENTITIES_MAX_COUNT];
+/* Index of the first skin for each hash plus one, 0 if none */
+static int skins_buckets[SKINS_HASH_BUCKETS];
+
+static int Skins_Hash(const cc_string* name) {
+	cc_uint32 hash = 0;
+	int i;
+
+	for (i = 0; i < name->length; i++) 
+	{
+		hash = hash * 31 + (cc_uint8)name->buffer[i];
+	}
+	return hash & (SKINS_HASH_BUCKETS - 1);
+}
+
+/* Returns the ID of the skin with the given name, adding it if not already in the registry */
+/* NOTE: Also increases the number of references to the skin */
+static int Skins_Acquire(const cc_string* name) {
+	struct Skin* skin;
+	cc_string skinName;
+	int hash = Skins_Hash(name), id;
+
+	for (id = skins_buckets[hash]; id; id = skin->next)
+	{
+		skin     = &skins[id - 1];
+		skinName = String_FromRawArray(skin->name);
+		if (!String_Equals(name, &skinName)) continue;
+
+		skin->refCount++;
+		return id;
+	}
+
+	for (id = 1; id <= ENTITIES_MAX_COUNT && skins[id - 1].refCount; id++) { }
+	if (id > ENTITIES_MAX_COUNT) Process_Abort("Too many skins in use");
+
+	skin = &skins[id - 1];
+	Mem_Set(skin, 0, sizeof(struct Skin));
+
+	String_CopyToRawArray(skin->name, name);
+	skin->refCount = 1;
+	skin->uScale   = 1.0f;
+	skin->vScale   = 1.0f;
+	skin->next     = skins_buckets[hash];
+	skins_buckets[hash] = id;
+	return id;
+}
+
+static void SkinJobs_Cancel(int reqID);
+/* Removes a reference to the given skin, freeing it once no entity is using it anymore */
+static void Skins_Release(int id) {
+	struct Skin* skin = &skins[id - 1];
+	cc_string name;
+	int* link;
+	if (--skin->refCount) return;
+
+	name = String_FromRawArray(skin->name);
+	Gfx_DeleteTexture(&skin->texID);
+
+	if (skin->reqID) {
+		Platform_Log1("Cancelling skin download: %s", &name);
+		Http_TryCancel(skin->reqID);
+		SkinJobs_Cancel(skin->reqID);
+		skin->reqID = 0;
+	}
+
+	for (link = &skins_buckets[Skins_Hash(&name)]; *link != id; link = &skins[*link - 1].next) { }
+	*link = skin->next;
+}
+
+/* Copies skin data from the given skin to the given entity */
+static void Entity_CopySkin(struct Entity* e, struct Skin* skin) {
+	e->TextureId = skin->texID;
+	e->uScale    = skin->uScale;
+	e->vScale    = skin->vScale;
+	if (skin->texID) e->SkinType = skin->skinType;
 }
 
 /* Resets skin data for the given entity */
@@ -223,60 +310,39 @@ static void Entity_ResetSkin(struct Entity* e) {
 }
 
 static void CheckSkin_Unchecked(struct Entity* e) {
-	cc_string skin, eSkin;
-	struct Entity* other;
+	cc_string name = String_FromRawArray(e->SkinRaw);
+	struct Skin* skin;
 	cc_uint8 flags;
-	int i;
 
-	skin = String_FromRawArray(e->SkinRaw);
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
-	{
-		other = Entities.List[i];
-		if (!other) continue;
-		/* Don't bother checking for other == e, as e->state is UNCHECKED anyways */
-		if (other->SkinFetchState < SKIN_FETCH_DOWNLOADING) continue;
-
-		eSkin = String_FromRawArray(other->SkinRaw);
-		if (!String_Equals(&skin, &eSkin)) continue;
-
-		/* Another entity with same skin either finished or is downloading */
-		if (other->SkinFetchState == SKIN_FETCH_COMPLETED) {
-			Entity_CopySkin(e, other);
-			e->SkinFetchState = SKIN_FETCH_COMPLETED;
-		} else {
-			e->SkinFetchState = SKIN_FETCH_WAITINGFOR;
-		}
+	e->_skinID = Skins_Acquire(&name);
+	skin       = &skins[e->_skinID - 1];
+
+	/* Another entity with same skin either finished or is downloading */
+	if (skin->completed) {
+		Entity_CopySkin(e, skin);
+		e->SkinFetchState = SKIN_FETCH_COMPLETED;
+		return;
+	} else if (skin->reqID) {
+		e->SkinFetchState = SKIN_FETCH_WAITINGFOR;
 		return;
 	}
 
-	flags = e == &LocalPlayer_Instances[0].Base ? HTTP_FLAG_NOCACHE : 0;
-	e->_skinReqID     = Http_AsyncGetSkin(&skin, flags);
+	if (e == &LocalPlayer_Instances[0].Base) {
+		flags = HTTP_FLAG_NOCACHE;
+	} else {
+		/* Skins of entities that can't currently be seen are downloaded last */
+		flags = Model_ShouldRender(e) ? 0 : HTTP_FLAG_BACKGROUND;
+	}
+
+	skin->clearHat    = (e->Model->flags & MODEL_FLAG_CLEAR_HAT) != 0;
+	skin->reqID       = Http_AsyncGetSkin(&name, flags);
 	e->SkinFetchState = SKIN_FETCH_DOWNLOADING;
 }
 
-/* Copies or resets skin data for all entity with same skin */
-static void Entity_SetSkinAll(struct Entity* source, cc_bool reset) {
-	struct Entity* e;
-	cc_string skin, eSkin;
-	int i;
-	
-	skin = String_FromRawArray(source->SkinRaw);
-
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
-	{
-		if (!Entities.List[i]) continue;
-
-		e     = Entities.List[i];
-		eSkin = String_FromRawArray(e->SkinRaw);
-		if (!String_Equals(&skin, &eSkin)) continue;
-
-		if (reset) {
-			Entity_ResetSkin(e);
-		} else {
-			Entity_CopySkin(e, source);
-		}
-		e->SkinFetchState = SKIN_FETCH_COMPLETED;
-	}
+/* Marks the skin as finished downloading, so entities using it start using its texture */
+static void Skin_Complete(struct Skin* skin) {
+	skin->completed = true;
+	skin->reqID     = 0;
 }
 
 /* Clears hat area from a skin bitmap if it's completely white or black,
@@ -306,7 +372,7 @@ static void Entity_ClearHat(struct Bitmap* bmp, cc_uint8 skinType) {
 }
 
 /* Ensures skin is a power of two size, resizing if needed. */
-static cc_result EnsurePow2Skin(struct Entity* e, struct Bitmap* bmp) {
+static cc_result EnsurePow2Skin(struct Bitmap* bmp) {
 	struct Bitmap scaled;
 	cc_uint32 stride;
 	int width, height;
@@ -320,9 +386,6 @@ static cc_result EnsurePow2Skin(struct Entity* e, struct Bitmap* bmp) {
 	scaled.height = height;
 	scaled.scan0  = (BitmapCol*)Mem_TryAllocCleared(width * height, BITMAPCOLOR_SIZE);
 	if (!scaled.scan0) return ERR_OUT_OF_MEMORY;
-
-	e->uScale = (float)bmp->width  / width;
-	e->vScale = (float)bmp->height / height;
 	stride = bmp->width * 4;
 
 	for (y = 0; y < bmp->height; y++) {
@@ -336,24 +399,19 @@ static cc_result EnsurePow2Skin(struct Entity* e, struct Bitmap* bmp) {
 	return 0;
 }
 
-static cc_result ApplySkin(struct Entity* e, struct Bitmap* bmp, struct Stream* src, cc_string* skin) {
-	cc_result res;
-	if ((res = Png_Decode(bmp, src))) return res;
-
-	Gfx_DeleteTexture(&e->TextureId);
-	if ((res = EnsurePow2Skin(e, bmp))) return res;
-	e->SkinType = Utils_CalcSkinType(bmp);
-
+/* srcWidth/srcHeight are the dimensions of the skin before it was resized to a power of two */
+static void ApplySkin(struct Skin* skin, struct Bitmap* bmp, int srcWidth, int srcHeight, cc_string* name) {
 	if (!Gfx_CheckTextureSize(bmp->width, bmp->height, 0)) {
-		Chat_Add1("&cSkin %s is too large", skin);
-	} else {
-		if (e->Model->flags & MODEL_FLAG_CLEAR_HAT)
-			Entity_ClearHat(bmp, e->SkinType);
-
-		e->TextureId = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
-		Entity_SetSkinAll(e, false);
+		Chat_Add1("&cSkin %s is too large", name);
+		return;
 	}
-	return 0;
+
+	skin->uScale   = (float)srcWidth  / bmp->width;
+	skin->vScale   = (float)srcHeight / bmp->height;
+	skin->skinType = Utils_CalcSkinType(bmp);
+
+	if (skin->clearHat) Entity_ClearHat(bmp, skin->skinType);
+	skin->texID = Gfx_CreateTexture(bmp, TEXTURE_FLAG_MANAGED, false);
 }
 
 static void LogInvalidSkin(cc_result res, const cc_string* skin, const cc_uint8* data, int size) {
@@ -369,97 +427,305 @@ static void LogInvalidSkin(cc_result res, const cc_string* skin, const cc_uint8*
 	Logger_WarnFunc(&msg);
 }
 
-static void CheckSkin_Downloading(struct Entity* e) {
-	struct HttpRequest item;
-	struct Stream mem;
+
+/*########################################################################################################################*
+*-------------------------------------------------------Skin uploads------------------------------------------------------*
+*#########################################################################################################################*/
+/* Downloaded skins are decoded on a background thread, and then uploaded to the GPU on the main thread. */
+/* Only a limited amount of skin data is uploaded each frame, so many players joining at once doesn't */
+/*  cause a long stall. Entities keep using the model's default texture until their skin is uploaded. */
+enum SkinJobState { SKINJOB_FREE, SKINJOB_QUEUED, SKINJOB_DECODING, SKINJOB_DONE };
+
+static struct SkinJob {
+	int reqID;
+	int skinID;              /* ID of the skin in the skin registry */
+	cc_uint8 state;
+	cc_bool cancelled;
+	cc_uint8* data;          /* Downloaded PNG data, freed once decoded */
+	cc_uint32 size;
+	cc_uint8 sig[8];         /* Start of the downloaded data, for logging invalid skins */
+	int sigLen;
 	struct Bitmap bmp;
-	cc_string skin;
+	int srcWidth, srcHeight; /* Dimensions before resizing to a power of two */
 	cc_result res;
+} skin_jobs[ENTITIES_MAX_COUNT];
+
+static void* skin_jobsMutex;
+static int skin_uploadBudget;
+
+static void SkinJob_Init(struct SkinJob* job, int skinID, int reqID, cc_uint8* data, cc_uint32 size) {
+	job->reqID     = reqID;
+	job->skinID    = skinID;
+	job->cancelled = false;
+	job->data      = data;
+	job->size      = size;
+	job->bmp.scan0 = NULL;
+	job->sigLen    = min(size, 8);
+	Mem_Copy(job->sig, data, job->sigLen);
+}
+
+static void SkinJob_Decode(struct SkinJob* job) {
+	struct Stream mem;
+	Stream_ReadonlyMemory(&mem, job->data, job->size);
+
+	job->res       = Png_Decode(&job->bmp, &mem);
+	job->srcWidth  = job->bmp.width;
+	job->srcHeight = job->bmp.height;
+	if (!job->res) job->res = EnsurePow2Skin(&job->bmp);
+
+	Mem_Free(job->data);
+	job->data = NULL;
+}
+
+#ifdef CC_BUILD_COOPTHREADED
+static void SkinJobs_Init(void) { }
+static void SkinJobs_StopWorker(void) { }
+static void SkinJobs_Wake(struct SkinJob* job) {
+	SkinJob_Decode(job);
+	job->state = SKINJOB_DONE;
+}
+#else
+static void* skin_waitable;
+static void* skin_thread;
+static cc_bool skin_quit;
+
+static void SkinWorker_Run(void) {
+	struct SkinJob job;
+	int i;
 
-	if (!Http_GetResult(e->_skinReqID, &item)) return;
-	Entity_SetSkinAll(e, true);
-	if (!item.success) return;
+	for (;;) {
+		Mutex_Lock(skin_jobsMutex);
+		{
+			if (skin_quit) { Mutex_Unlock(skin_jobsMutex); return; }
 
-	Stream_ReadonlyMemory(&mem, item.data, item.size);
-	skin = String_FromRawArray(e->SkinRaw);
+			for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+			{
+				if (skin_jobs[i].state == SKINJOB_QUEUED) break;
+			}
+			if (i < ENTITIES_MAX_COUNT) {
+				skin_jobs[i].state = SKINJOB_DECODING;
+				job = skin_jobs[i];
+			}
+		}
+		Mutex_Unlock(skin_jobsMutex);
 
-	if ((res = ApplySkin(e, &bmp, &mem, &skin))) {
-		LogInvalidSkin(res, &skin, item.data, item.size);
+		if (i == ENTITIES_MAX_COUNT) {
+			/* Block until the main thread queues another skin to decode */
+			Waitable_Wait(skin_waitable);
+			continue;
+		}
+		SkinJob_Decode(&job);
+
+		Mutex_Lock(skin_jobsMutex);
+		{
+			/* Entity may have stopped using the skin while it was being decoded */
+			if (skin_jobs[i].cancelled) {
+				Mem_Free(job.bmp.scan0);
+				job.bmp.scan0 = NULL;
+				job.state     = SKINJOB_FREE;
+			} else {
+				job.state = SKINJOB_DONE;
+			}
+			job.cancelled = false;
+			skin_jobs[i]  = job;
+		}
+		Mutex_Unlock(skin_jobsMutex);
 	}
+}
 
-	Mem_Free(bmp.scan0);
-	HttpRequest_Free(&item);
+static void SkinJobs_Init(void) {
+	if (skin_thread) return;
+	skin_quit     = false;
+	skin_waitable = Waitable_Create("Skin decode wakeup");
+	Thread_Run(&skin_thread, SkinWorker_Run, 128 * 1024, "Skin decoder");
 }
 
-static void Entity_CheckSkin(struct Entity* e) {
-	/* Don't check skin if don't have to */
-	if (!e->Model->usesSkin) return;
+static void SkinJobs_StopWorker(void) {
+	if (!skin_thread) return;
 
-	switch (e->SkinFetchState)
+	Mutex_Lock(skin_jobsMutex);
+	skin_quit = true;
+	Mutex_Unlock(skin_jobsMutex);
+
+	Waitable_Signal(skin_waitable);
+	Thread_Join(skin_thread);
+	Waitable_Free(skin_waitable);
+
+	skin_thread   = NULL;
+	skin_waitable = NULL;
+}
+
+static void SkinJobs_Wake(struct SkinJob* job) {
+	Waitable_Signal(skin_waitable);
+}
+#endif
+
+/* Queues the downloaded data of a skin for decoding, taking ownership of the data */
+static cc_bool SkinJobs_Queue(int skinID, int reqID, cc_uint8* data, cc_uint32 size) {
+	struct SkinJob* job = NULL;
+	int i;
+
+	Mutex_Lock(skin_jobsMutex);
 	{
-	case SKIN_FETCH_UNCHECKED:
-		CheckSkin_Unchecked(e); return;
-	case SKIN_FETCH_WAITINGFOR:
-		return; /* Waiting for another entity to download it */
-	case SKIN_FETCH_DOWNLOADING:
-		CheckSkin_Downloading(e); return;
-	case SKIN_FETCH_COMPLETED:
-		return; /* Nothing to do as skin has been downloaded */
+		for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+		{
+			if (skin_jobs[i].state != SKINJOB_FREE) continue;
+			job = &skin_jobs[i];
+
+			SkinJob_Init(job, skinID, reqID, data, size);
+			job->state = SKINJOB_QUEUED;
+			break;
+		}
 	}
+	Mutex_Unlock(skin_jobsMutex);
+
+	if (job) SkinJobs_Wake(job);
+	return job != NULL;
 }
 
-/* Returns whether this entity is currently waiting on given skin to download */
-static CC_INLINE cc_bool IsWaitingForSkinToDownload(struct Entity* e, cc_string* skin) {
-	cc_string eSkin;
-	if (e->SkinFetchState != SKIN_FETCH_WAITINGFOR) return false;
+static cc_bool SkinJobs_TakeDone(struct SkinJob* dst) {
+	int i;
+	Mutex_Lock(skin_jobsMutex);
+	{
+		for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+		{
+			if (skin_jobs[i].state != SKINJOB_DONE) continue;
+
+			/* Caller takes ownership of the decoded bitmap */
+			*dst = skin_jobs[i];
+			skin_jobs[i].bmp.scan0 = NULL;
+			skin_jobs[i].state     = SKINJOB_FREE;
+			break;
+		}
+	}
+	Mutex_Unlock(skin_jobsMutex);
+	return i < ENTITIES_MAX_COUNT;
+}
+
+static void SkinJobs_Cancel(int reqID) {
+	struct SkinJob* job;
+	int i;
 
-	eSkin = String_FromRawArray(e->SkinRaw);
-	return String_Equals(skin, &eSkin);
+	Mutex_Lock(skin_jobsMutex);
+	{
+		for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+		{
+			job = &skin_jobs[i];
+			if (job->state == SKINJOB_FREE || job->reqID != reqID) continue;
+
+			if (job->state == SKINJOB_DECODING) {
+				/* Worker thread frees the data once done */
+				job->cancelled = true;
+			} else {
+				Mem_Free(job->data);
+				Mem_Free(job->bmp.scan0);
+				job->data      = NULL;
+				job->bmp.scan0 = NULL;
+				job->state     = SKINJOB_FREE;
+			}
+			break;
+		}
+	}
+	Mutex_Unlock(skin_jobsMutex);
 }
 
-/* Transfers skin downloading responsibility to another entity */
-static void TransferSkinDownload(struct Entity* e, struct Entity* src) {
-	e->SkinFetchState = SKIN_FETCH_DOWNLOADING;
-	e->_skinReqID     = src->_skinReqID;
+static void SkinJob_Apply(struct SkinJob* job) {
+	struct Skin* skin = &skins[job->skinID - 1];
+	cc_string name;
+	/* Skin may have been freed (and possibly reused) since the job was queued */
+	if (!skin->refCount || skin->reqID != job->reqID) return;
+
+	Skin_Complete(skin);
+	name = String_FromRawArray(skin->name);
+
+	if (job->res) {
+		LogInvalidSkin(job->res, &name, job->sig, job->sigLen);
+	} else {
+		ApplySkin(skin, &job->bmp, job->srcWidth, job->srcHeight, &name);
+	}
 }
 
-/* Either transfers skin download or cancels it altogether */
-static void DerefDownloadingSkin(struct Entity* src) {
-	struct Entity* e;
-	cc_string skin = String_FromRawArray(src->SkinRaw);
+/* Uploads decoded skins to the GPU, until this frame's upload budget is used up */
+static void Entities_UploadSkins(void) {
+	int budget = skin_uploadBudget;
+	struct SkinJob job;
+
+	while (budget > 0 && SkinJobs_TakeDone(&job)) 
+	{
+		SkinJob_Apply(&job);
+		budget -= Bitmap_DataSize(job.bmp.width, job.bmp.height);
+		Mem_Free(job.bmp.scan0);
+	}
+}
+
+/* Decodes and applies a skin on the main thread, for when all skin jobs are in use */
+static void SkinJob_DecodeNow(int skinID, int reqID, cc_uint8* data, cc_uint32 size) {
+	struct SkinJob job;
+	SkinJob_Init(&job, skinID, reqID, data, size);
+	SkinJob_Decode(&job);
+
+	SkinJob_Apply(&job);
+	Mem_Free(job.bmp.scan0);
+}
+
+static void SkinJobs_Free(void) {
 	int i;
+	SkinJobs_StopWorker();
 
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++) 
+	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
 	{
-		if (!Entities.List[i]) continue;
-		e  = Entities.List[i];
+		Mem_Free(skin_jobs[i].data);
+		Mem_Free(skin_jobs[i].bmp.scan0);
+		skin_jobs[i].data      = NULL;
+		skin_jobs[i].bmp.scan0 = NULL;
+		skin_jobs[i].state     = SKINJOB_FREE;
+	}
+	Mutex_Free(skin_jobsMutex);
+	skin_jobsMutex = NULL;
+}
 
-		if (!IsWaitingForSkinToDownload(e, &skin)) continue;
-		Platform_Log1("Transferring skin download: %s", &skin);
-		TransferSkinDownload(e, src);
+static void CheckSkin_Downloading(struct Entity* e) {
+	struct Skin* skin = &skins[e->_skinID - 1];
+	struct HttpRequest item;
+
+	if (skin->completed) {
+		Entity_CopySkin(e, skin);
+		e->SkinFetchState = SKIN_FETCH_COMPLETED;
 		return;
 	}
-	
-	Platform_Log1("Cancelling skin download: %s", &skin);
-	Http_TryCancel(src->_skinReqID);
+	/* Skin stays in downloading state until it has been uploaded */
+	if (!skin->reqID || !Http_GetResult(skin->reqID, &item)) return;
+
+	if (!item.success) {
+		Skin_Complete(skin);
+	} else if (!SkinJobs_Queue(e->_skinID, skin->reqID, item.data, item.size)) {
+		SkinJob_DecodeNow(e->_skinID, skin->reqID, item.data, item.size);
+	}
+
+	/* Skin jobs take ownership of the downloaded data */
+	if (item.success) item.data = NULL;
+	HttpRequest_Free(&item);
 }
 
-/* Returns true if no other entities are sharing this skin texture */
-static cc_bool CanDeleteTexture(struct Entity* except) {
-	int i;
-	if (!except->TextureId) return false;
+static void Entity_CheckSkin(struct Entity* e) {
+	/* Don't check skin if don't have to */
+	if (!e->Model->usesSkin) return;
 
-	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
+	switch (e->SkinFetchState)
 	{
-		if (!Entities.List[i] || Entities.List[i] == except)  continue;
-		if (Entities.List[i]->TextureId == except->TextureId) return false;
+	case SKIN_FETCH_UNCHECKED:
+		CheckSkin_Unchecked(e); return;
+	case SKIN_FETCH_WAITINGFOR:
+	case SKIN_FETCH_DOWNLOADING:
+		CheckSkin_Downloading(e); return;
+	case SKIN_FETCH_COMPLETED:
+		return; /* Nothing to do as skin has been downloaded */
 	}
-	return true;
 }
 
 CC_NOINLINE static void DeleteSkin(struct Entity* e) {
-	if (CanDeleteTexture(e)) Gfx_DeleteTexture(&e->TextureId);
-	if (e->SkinFetchState == SKIN_FETCH_DOWNLOADING) DerefDownloadingSkin(e);
+	if (e->_skinID) Skins_Release(e->_skinID);
+	e->_skinID = 0;
 
 	Entity_ResetSkin(e);
 	e->SkinFetchState = SKIN_FETCH_UNCHECKED;
@@ -510,6 +776,7 @@ static cc_bool Entities_Tick(struct ScheduledTask2* task) {
 
 void Entities_RenderModels(float delta, float t) {
 	int i;
+	Entities_UploadSkins();
 	Gfx_SetAlphaTest(true);
 	
 	for (i = 0; i < ENTITIES_MAX_COUNT; i++)
@@ -1190,6 +1457,10 @@ static void Entities_Init(void) {
 		ShadowMode_Names, Array_Elems(ShadowMode_Names));
 	if (Game_ClassicMode) Entities.ShadowsMode = SHADOW_MODE_NONE;
 
+	skin_uploadBudget = Options_GetInt(OPT_SKIN_UPLOAD_KB, 16, 65536, 256) * 1024;
+	if (!skin_jobsMutex) skin_jobsMutex = Mutex_Create("Skin jobs");
+	SkinJobs_Init();
+
 	for (i = 0; i < Game_NumStates; i++)
 	{
 		LocalPlayer_Init(&LocalPlayer_Instances[i], i);
@@ -1214,6 +1485,7 @@ static void Entities_Free(void) {
 		Entities_Remove(i);
 	}
 	sources_head = NULL;
+	SkinJobs_Free();
 }
 
 struct IGameComponent Entities_Component = {
@@ -121,7 +121,7 @@ struct Entity {
 	cc_uint8 ShouldRender;
 	struct AABB ModelAABB;
 	Vec3 ModelScale, Size;
-	int _skinReqID;
+	int _skinID; /* (private) ID of the skin in the skin registry, 0 if none */
 	
 	cc_uint8 SkinType;
 	cc_uint8 SkinFetchState;
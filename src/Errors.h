@@ -139,5 +139,8 @@ enum CC_ERRORS {
 	PNG_ERR_16BITSAMPLES = 0xCCDED071UL, /* Image uses 16 bit samples, which is unimplemented */
 	ERR_NO_NETWORKING    = 0xCCDED072UL, /* No working network connection */
 	ERR_NON_WRITABLE_FS  = 0xCCDED073UL, /* No writable filesystem detected */
+	MAP_ERR_CACHE_STALE  = 0xCCDED074UL, /* Fast load map cache is invalid or out of date */
+	CCR_ERR_INVALID_HDR  = 0xCCDED075UL, /* Region map file header is invalid or unsupported */
+	CCR_ERR_REGION_DATA  = 0xCCDED076UL, /* Region map file contains corrupted region data */
 };
 #endif
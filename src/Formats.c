@@ -17,6 +17,8 @@
 #include "TexturePack.h"
 #include "Utils.h"
 #include "Audio.h"
+#include "Protocol.h"
+#include "Options.h"
 
 #ifdef CC_BUILD_FILESYSTEM
 static struct LocationUpdate* spawn_point;
@@ -46,6 +48,42 @@ static cc_result Map_SkipGZipHeader(struct Stream* stream) {
 	return 0;
 }
 
+static cc_result Map_MemWrite(struct Stream* s, const cc_uint8* data, cc_uint32 count, cc_uint32* modified) {
+	cc_uint32 used, size;
+	cc_uint8* base;
+
+	if (count > s->meta.mem.left) {
+		used = (cc_uint32)(s->meta.mem.cur - s->meta.mem.base);
+		size = max(s->meta.mem.length * 2, used + count);
+
+		base = (cc_uint8*)Mem_TryRealloc(s->meta.mem.base, size, 1);
+		if (!base) return ERR_OUT_OF_MEMORY;
+
+		s->meta.mem.base   = base;
+		s->meta.mem.cur    = base + used;
+		s->meta.mem.length = size;
+		s->meta.mem.left   = size - used;
+	}
+
+	Mem_Copy(s->meta.mem.cur, data, count);
+	s->meta.mem.cur  += count;
+	s->meta.mem.left -= count;
+	*modified = count; return 0;
+}
+
+/* Initialises a write only stream that writes into a growable block of memory */
+/* NOTE: The memory must be freed using Mem_Free(s->meta.mem.base) */
+static cc_result Map_OpenMemWriter(struct Stream* s, cc_uint32 capacity) {
+	Stream_Init(s);
+	s->Write = Map_MemWrite;
+	s->meta.mem.base   = (cc_uint8*)Mem_TryAlloc(capacity, 1);
+	s->meta.mem.cur    = s->meta.mem.base;
+	s->meta.mem.length = capacity;
+	s->meta.mem.left   = capacity;
+	return s->meta.mem.base ? 0 : ERR_OUT_OF_MEMORY;
+}
+#define Map_MemWriterLength(s) ((cc_uint32)((s)->meta.mem.cur - (s)->meta.mem.base))
+
 void MapImporter_Register(struct MapImporter* imp) {
 	LinkedList_Append(imp, imp_head, imp_tail);
 }
@@ -73,21 +111,27 @@ cc_result Map_LoadFrom(const cc_string* path) {
 	Game_Reset();
 	spawn_point = &update;
 
-	Platform_EncodePath(&raw_path, path);
-	res = Stream_OpenPath(&stream, &raw_path);
-	if (res) { Logger_IOWarn2(res, "opening", &raw_path); return res; }
+	/* An up to date fast load cache avoids having to decompress the map */
+	res = Options_GetBool(OPT_MAP_FASTLOAD, false) ? Map_LoadCache(path) : ReturnCode_FileNotFound;
+	if (res) {
+		/* Cache may have set spawn before failing */
+		update.flags = 0;
+		Platform_EncodePath(&raw_path, path);
+		res = Stream_OpenPath(&stream, &raw_path);
+		if (res) { Logger_IOWarn2(res, "opening", &raw_path); return res; }
+
+		imp = MapImporter_Find(path);
+		if (!imp) {
+			res = ERR_NOT_SUPPORTED;
+		} else if ((res = imp->import(&stream))) {
+			World_Reset();
+		}
 
-	imp = MapImporter_Find(path);
-	if (!imp) {
-		res = ERR_NOT_SUPPORTED;
-	} else if ((res = imp->import(&stream))) {
-		World_Reset();
+		/* No point logging error for closing readonly file */
+		(void)stream.Close(&stream);
+		if (res) Logger_IOWarn2(res, "decoding", &raw_path);
 	}
 
-	/* No point logging error for closing readonly file */
-	(void)stream.Close(&stream);
-	if (res) Logger_IOWarn2(res, "decoding", &raw_path);
-
 	World_SetNewMap(World.Blocks, World.Width, World.Height, World.Length);
 	if (!spawn_point) LocalPlayer_CalcDefaultSpawn(Entities.CurPlayer, &update);
 	LocalPlayers_MoveToSpawn(&update);
@@ -322,16 +366,24 @@ enum NbtTagType {
 
 #define NBT_SMALL_SIZE  STRING_SIZE
 #define NBT_STRING_SIZE STRING_SIZE
+#define NBT_BUFFER_SIZE 4096
 
-#define NbtTag_IsSmall(tag) ((tag)->dataSize <= NBT_SMALL_SIZE)
-#define IsTag(tag, tagName) (String_CaselessEqualsConst(&tag->name, tagName))
-struct NbtTag;
+#define IsTag(tag, tagName) (String_CaselessEqualsConst(&(tag)->name, tagName))
+
+/* Pull based reader, which reads tags on demand from a buffer of decompressed NBT data */
+struct NbtReader {
+	struct Stream* source; /* Stream of decompressed NBT data */
+	cc_uint8* cur;         /* Next unread byte in the buffer */
+	cc_uint32 left;        /* Number of unread bytes in the buffer */
+	cc_uint8 buffer[NBT_BUFFER_SIZE];
+};
 
 struct NbtTag {
-	struct NbtTag* parent;
 	cc_uint8  type;
+	cc_uint8  childType; /* type of elements for lists */
+	cc_bool   hasData;   /* whether data of array/list/compound tag is still to be read */
 	cc_string name;
-	cc_uint32 dataSize; /* size of data for arrays */
+	cc_uint32 count;     /* number of elements for arrays and lists */
 
 	union {
 		cc_uint8  u8;
@@ -340,13 +392,10 @@ struct NbtTag {
 		cc_int32  i32;
 		cc_uint32 u32;
 		float     f32;
-		cc_uint8  small[NBT_SMALL_SIZE];
-		cc_uint8* big; /* malloc for big byte arrays */
 		struct { cc_string text; char buffer[STRING_SIZE * 2]; } str;
 	} value;
 	char _nameBuffer[NBT_STRING_SIZE];
 	cc_result result;
-	int listIndex;
 };
 
 static cc_uint8 NbtTag_U8(struct NbtTag* tag) {
@@ -388,13 +437,6 @@ static float NbtTag_F32(struct NbtTag* tag) {
 	return 0;
 }
 
-static cc_uint8* NbtTag_U8_Array(struct NbtTag* tag, int minSize) {
-	if (tag->type != NBT_I8S)    { tag->result = NBT_ERR_EXPECTED_ARR;  return NULL; }
-	if (tag->dataSize < minSize) { tag->result = NBT_ERR_ARR_TOO_SMALL; return NULL; }
-
-	return NbtTag_IsSmall(tag) ? tag->value.small : tag->value.big;
-}
-
 static cc_string NbtTag_String(struct NbtTag* tag) {
 	if (tag->type == NBT_STR) return tag->value.str.text;
 
@@ -402,138 +444,245 @@ static cc_string NbtTag_String(struct NbtTag* tag) {
 	return String_Empty;
 }
 
-static cc_result Nbt_ReadString(struct Stream* stream, cc_string* str) {
-	cc_uint8 buffer[NBT_STRING_SIZE * 4];
-	int len;
+
+static void NbtReader_Init(struct NbtReader* r, struct Stream* source) {
+	r->source = source;
+	r->cur    = r->buffer;
+	r->left   = 0;
+}
+
+/* Ensures at least 'count' unread bytes are in the buffer */
+static cc_result NbtReader_Fill(struct NbtReader* r, cc_uint32 count) {
+	cc_uint32 read;
 	cc_result res;
+	if (r->left >= count) return 0;
 
-	if ((res = Stream_Read(stream, buffer, 2)))   return res;
-	len = Mem_ReadU16_BE(buffer);
+	/* Move remaining unread data to start of buffer */
+	Mem_Move(r->buffer, r->cur, r->left);
+	r->cur = r->buffer;
+
+	while (r->left < count) {
+		res = r->source->Read(r->source, r->buffer + r->left, NBT_BUFFER_SIZE - r->left, &read);
+		if (res)   return res;
+		if (!read) return ERR_END_OF_STREAM;
+		r->left += read;
+	}
+	return 0;
+}
+
+#define NbtReader_Take(r, count, ptr) \
+	if ((res = NbtReader_Fill(r, count))) return res; \
+	ptr = r->cur; r->cur += count; r->left -= count;
+
+static cc_result NbtReader_Read(struct NbtReader* r, cc_uint8* data, cc_uint32 count) {
+	cc_uint32 len = min(count, r->left);
+	cc_result res;
+
+	Mem_Copy(data, r->cur, len);
+	r->cur  += len; r->left -= len;
+	data    += len; count   -= len;
+	if (!count) return 0;
 
-	if (len > Array_Elems(buffer)) return CW_ERR_STRING_LEN;
-	if ((res = Stream_Read(stream, buffer, len))) return res;
+	/* Large data (e.g. block arrays) is directly decompressed into the destination */
+	if (count >= NBT_BUFFER_SIZE) return Stream_Read(r->source, data, count);
 
-	String_AppendUtf8(str, buffer, len);
+	if ((res = NbtReader_Fill(r, count))) return res;
+	Mem_Copy(data, r->cur, count);
+	r->cur += count; r->left -= count;
 	return 0;
 }
 
-typedef void (*Nbt_Callback)(struct NbtTag* tag);
-static cc_result Nbt_ReadTag(cc_uint8 typeId, cc_bool readTagName, struct Stream* stream, 
-							struct NbtTag* parent, Nbt_Callback callback, int listIndex) {
-	struct NbtTag tag;
-	cc_uint8 childType;
-	cc_uint8 tmp[5];	
+static cc_result NbtReader_Skip(struct NbtReader* r, cc_uint32 count) {
+	cc_uint32 len = min(count, r->left);
+	r->cur += len; r->left -= len;
+
+	count -= len;
+	return count ? r->source->Skip(r->source, count) : 0;
+}
+
+static cc_result Nbt_ReadString(struct NbtReader* r, cc_string* str) {
+	cc_uint8* data;
+	cc_uint32 len;
 	cc_result res;
-	cc_uint32 i, count;
-	
-	if (typeId == NBT_END) return 0;
-	tag.type      = typeId; 
-	tag.parent    = parent;
-	tag.dataSize  = 0;
-	tag.listIndex = listIndex;
-	String_InitArray(tag.name, tag._nameBuffer);
-
-	if (readTagName) {
-		res = Nbt_ReadString(stream, &tag.name);
-		if (res) return res;
-	}
 
-	switch (typeId) {
+	NbtReader_Take(r, 2, data);
+	len = Mem_ReadU16_BE(data);
+	if (len > NBT_STRING_SIZE * 4) return CW_ERR_STRING_LEN;
+
+	NbtReader_Take(r, len, data);
+	String_AppendUtf8(str, data, len);
+	return 0;
+}
+
+/* Reads the value of a tag whose type has already been read */
+/* NOTE: Only the length of arrays and lists is read, and nothing for compound tags */
+static cc_result Nbt_ReadValue(struct NbtReader* r, struct NbtTag* tag) {
+	cc_uint8* data;
+	cc_result res;
+	tag->count   = 0;
+	tag->hasData = false;
+	tag->result  = 0;
+
+	switch (tag->type) {
 	case NBT_I8:
-		res = stream->ReadU8(stream, &tag.value.u8);
-		break;
+		NbtReader_Take(r, 1, data);
+		tag->value.u8 = data[0];
+		return 0;
 	case NBT_I16:
-		res = Stream_Read(stream, tmp, 2);
-		tag.value.u16 = Mem_ReadU16_BE(tmp);
-		break;
+		NbtReader_Take(r, 2, data);
+		tag->value.u16 = Mem_ReadU16_BE(data);
+		return 0;
 	case NBT_I32:
 	case NBT_F32:
-		res = Stream_ReadU32_BE(stream, &tag.value.u32);
-		break;
+		NbtReader_Take(r, 4, data);
+		tag->value.u32 = Mem_ReadU32_BE(data);
+		return 0;
 	case NBT_I64:
 	case NBT_F64:
-		res = stream->Skip(stream, 8);
-		break; /* (8) data */
+		return NbtReader_Skip(r, 8);
 
 	case NBT_I8S:
-		if ((res = Stream_ReadU32_BE(stream, &tag.dataSize))) break;
-
-		if (NbtTag_IsSmall(&tag)) {
-			res = Stream_Read(stream, tag.value.small, tag.dataSize);
-		} else {
-			tag.value.big = (cc_uint8*)Mem_TryAlloc(tag.dataSize, 1);
-			if (!tag.value.big) return ERR_OUT_OF_MEMORY;
-
-			res = Stream_Read(stream, tag.value.big, tag.dataSize);
-			if (res) Mem_Free(tag.value.big);
-		}
-		break;
+		NbtReader_Take(r, 4, data);
+		tag->count   = Mem_ReadU32_BE(data);
+		tag->hasData = true;
+		return 0;
 	case NBT_STR:
-		String_InitArray(tag.value.str.text, tag.value.str.buffer);
-		res = Nbt_ReadString(stream, &tag.value.str.text);
-		break;
+		String_InitArray(tag->value.str.text, tag->value.str.buffer);
+		return Nbt_ReadString(r, &tag->value.str.text);
 
 	case NBT_LIST:
-		if ((res = Stream_Read(stream, tmp, 5))) break;
-		childType = tmp[0];
-		count = Mem_ReadU32_BE(&tmp[1]);
+		NbtReader_Take(r, 5, data);
+		tag->childType = data[0];
+		tag->count     = Mem_ReadU32_BE(&data[1]);
+		tag->hasData   = true;
+		return 0;
+	case NBT_DICT:
+		tag->hasData = true;
+		return 0;
+	case NBT_END:
+		return 0; /* only possible for elements of empty lists */
+	}
+	return NBT_ERR_UNKNOWN;
+}
+
+/* Reads the type, name, and value of the next tag in a compound tag */
+/* NOTE: tag->type is NBT_END when there are no more tags in the compound tag */
+static cc_result Nbt_ReadTag(struct NbtReader* r, struct NbtTag* tag) {
+	cc_uint8* data;
+	cc_result res;
+
+	NbtReader_Take(r, 1, data);
+	tag->type = data[0];
+	String_InitArray(tag->name, tag->_nameBuffer);
+	if (tag->type == NBT_END) return 0;
+
+	if ((res = Nbt_ReadString(r, &(tag)->name))) return res;
+	return Nbt_ReadValue(r, tag);
+}
+
+/* Reads the value of the next element in a list tag */
+static cc_result Nbt_ReadItem(struct NbtReader* r, struct NbtTag* list, struct NbtTag* item) {
+	item->type = list->childType;
+	String_InitArray(item->name, item->_nameBuffer);
+	return Nbt_ReadValue(r, item);
+}
+
+static cc_result Nbt_SkipData(struct NbtReader* r, struct NbtTag* tag) {
+	struct NbtTag child;
+	cc_uint32 i;
+	cc_result res;
+	tag->hasData = false;
+
+	switch (tag->type) {
+	case NBT_I8S:
+		return NbtReader_Skip(r, tag->count);
 
-		for (i = 0; i < count; i++) {
-			res = Nbt_ReadTag(childType, false, stream, &tag, callback, i);
-			if (res) break;
+	case NBT_LIST:
+		for (i = 0; i < tag->count; i++) {
+			if ((res = Nbt_ReadItem(r, tag, &child))) return res;
+			if (child.hasData && (res = Nbt_SkipData(r, &child))) return res;
 		}
-		break;
+		return 0;
 
 	case NBT_DICT:
 		for (;;) {
-			if ((res = stream->ReadU8(stream, &childType))) break;
-			if (childType == NBT_END) break;
-
-			res = Nbt_ReadTag(childType, true, stream, &tag, callback, 0);
-			if (res) break;
+			if ((res = Nbt_ReadTag(r, &child))) return res;
+			if (child.type == NBT_END) return 0;
+			if (child.hasData && (res = Nbt_SkipData(r, &child))) return res;
 		}
-		break;
-
-	default: return NBT_ERR_UNKNOWN;
 	}
+	return 0;
+}
 
-	if (res) return res;
-	tag.result = 0;
-	callback(&tag);
-	/* NOTE: callback must set DataBig to NULL, if doesn't want it to be freed */
-	if (!NbtTag_IsSmall(&tag)) Mem_Free(tag.value.big);
-	return tag.result;
+/* Skips any data of the tag that was not read, then returns any error from reading the tag */
+static cc_result Nbt_FinishTag(struct NbtReader* r, struct NbtTag* tag) {
+	cc_result res;
+	if (tag->hasData && (res = Nbt_SkipData(r, tag))) return res;
+	return tag->result;
 }
 
+/* Returns whether the tag is a compound tag, whose children can then be read using Nbt_ReadTag */
+static cc_bool Nbt_EnterDict(struct NbtTag* tag) {
+	if (tag->type != NBT_DICT) return false;
+	tag->hasData = false;
+	return true;
+}
 
-static BlockRaw* Nbt_TakeArray(struct NbtTag* tag, const char* type) {
-	BlockRaw* ptr;
-	if (NbtTag_IsSmall(tag)) {
-		/* Small data is stored inline in tha tag, so need to copy it out */
-		ptr = (BlockRaw*)Mem_Alloc(tag->dataSize, 1, type);
-		Mem_Copy(ptr, tag->value.small, tag->dataSize);
-	} else {
-		ptr = tag->value.big;
-		tag->value.big = NULL; /* So Nbt_ReadTag doesn't call Mem_Free on the array */
+/* Reads all the data of a byte array tag */
+static cc_result Nbt_ReadArray(struct NbtReader* r, struct NbtTag* tag, cc_uint8* data) {
+	tag->hasData = false;
+	return NbtReader_Read(r, data, tag->count);
+}
+
+/* Reads up to the first NBT_SMALL_SIZE bytes of a byte array tag's data */
+static cc_uint8* Nbt_ReadSmallArray(struct NbtReader* r, struct NbtTag* tag, cc_uint8* data, cc_uint32 minSize) {
+	cc_uint32 len = min(tag->count, NBT_SMALL_SIZE);
+	if (tag->type != NBT_I8S)  { tag->result = NBT_ERR_EXPECTED_ARR;  return NULL; }
+	if (tag->count < minSize)  { tag->result = NBT_ERR_ARR_TOO_SMALL; return NULL; }
+
+	tag->hasData = false;
+	if ((tag->result = NbtReader_Read(r, data, len)))              return NULL;
+	if ((tag->result = NbtReader_Skip(r, tag->count - len)))      return NULL;
+	return data;
+}
+
+/* Allocates and then reads all the data of a byte array tag (e.g. map blocks) */
+static cc_result Nbt_ReadBigArray(struct NbtReader* r, struct NbtTag* tag, BlockRaw** data) {
+	cc_result res;
+	if (tag->type != NBT_I8S) return NBT_ERR_EXPECTED_ARR;
+
+	*data = (BlockRaw*)Mem_TryAlloc(tag->count, 1);
+	if (!(*data)) return ERR_OUT_OF_MEMORY;
+
+	if ((res = Nbt_ReadArray(r, tag, *data))) {
+		Mem_Free(*data); *data = NULL;
 	}
-	return ptr;
+	return res;
+}
+
+typedef cc_result (*Nbt_RootReader)(struct NbtReader* r);
+/* Reads the root compound tag of uncompressed NBT data */
+static cc_result Nbt_ReadRoot(struct Stream* stream, Nbt_RootReader readRoot) {
+	struct NbtReader reader;
+	struct NbtTag root;
+	cc_result res;
+	NbtReader_Init(&reader, stream);
+
+	if ((res = Nbt_ReadTag(&reader, &root))) return res;
+	if (root.type != NBT_DICT) return CW_ERR_ROOT_TAG;
+	return readRoot(&reader);
 }
 
-static cc_result Nbt_Read(struct Stream* stream, Nbt_Callback callback) {
+static cc_result Nbt_Read(struct Stream* stream, Nbt_RootReader readRoot) {
 	struct Stream compStream;
 	struct InflateState state;
 	cc_result res;
-	cc_uint8 tag;
 
 	Inflate_MakeStream2(&compStream, &state, stream);
 	if ((res = Map_SkipGZipHeader(stream))) return res;
-	if ((res = compStream.ReadU8(&compStream, &tag))) return res;
-
-	if (tag != NBT_DICT) return CW_ERR_ROOT_TAG;
-	return Nbt_ReadTag(NBT_DICT, true, &compStream, NULL, callback, 0);
+	return Nbt_ReadRoot(&compStream, readRoot);
 }
 
-
 /*########################################################################################################################*
 *--------------------------------------------------------NBTWriter--------------------------------------------------------*
 *#########################################################################################################################*/
@@ -656,47 +805,43 @@ COMPOUND "ClassicWorld" {
 	}
 }*/
 
-static void Cw_Callback_1(struct NbtTag* tag) {
-	if (IsTag(tag, "X")) { World.Width  = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "Y")) { World.Height = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "Z")) { World.Length = NbtTag_U16(tag); return; }
+static cc_result Cw_ReadMapGenerator(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
 
-	if (IsTag(tag, "UUID")) {
-		if (tag->dataSize != WORLD_UUID_LEN) {
-			tag->result = CW_ERR_UUID_LEN;
-		} else {
-			Mem_Copy(World.Uuid, tag->value.small, WORLD_UUID_LEN);
-		}
-		return;
-	}
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
 
-	if (IsTag(tag, "BlockArray")) {
-		World.Volume = tag->dataSize;
-		World.Blocks = Nbt_TakeArray(tag, ".cw map blocks");
-	}
-#ifdef EXTENDED_BLOCKS
-	if (IsTag(tag, "BlockArray2")) {
-		World_SetMapUpper(Nbt_TakeArray(tag, ".cw map blocks2"));
+		if (IsTag(&tag, "Seed")) World.Seed = NbtTag_I32(&tag);
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
-#endif
 }
 
-static void Cw_Callback_2(struct NbtTag* tag) {
-	if (IsTag(tag->parent, "MapGenerator")) {
-		if (IsTag(tag, "Seed")) { World.Seed = NbtTag_I32(tag); return; }
-		return;
+static cc_result Cw_ReadSpawn(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
+
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
+		spawn_point->flags = LU_HAS_POS | LU_HAS_YAW | LU_HAS_PITCH;
+
+		if (IsTag(&tag, "X")) {
+			spawn_point->pos.x = NbtTag_I16(&tag);
+		} else if (IsTag(&tag, "Y")) {
+			spawn_point->pos.y = NbtTag_I16(&tag);
+		} else if (IsTag(&tag, "Z")) {
+			spawn_point->pos.z = NbtTag_I16(&tag);
+		} else if (IsTag(&tag, "H")) {
+			spawn_point->yaw   = Math_Packed2Deg(NbtTag_U8(&tag));
+		} else if (IsTag(&tag, "P")) {
+			spawn_point->pitch = Math_Packed2Deg(NbtTag_U8(&tag));
+		}
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
-	if (!IsTag(tag->parent, "Spawn")) return;
-	spawn_point->flags = LU_HAS_POS | LU_HAS_YAW | LU_HAS_PITCH;
-	
-	if (IsTag(tag, "X")) { spawn_point->pos.x = NbtTag_I16(tag); return; }
-	if (IsTag(tag, "Y")) { spawn_point->pos.y = NbtTag_I16(tag); return; }
-	if (IsTag(tag, "Z")) { spawn_point->pos.z = NbtTag_I16(tag); return; }
-	if (IsTag(tag, "H")) { spawn_point->yaw   = Math_Packed2Deg(NbtTag_U8(tag)); return; }
-	if (IsTag(tag, "P")) { spawn_point->pitch = Math_Packed2Deg(NbtTag_U8(tag)); return; }
 }
 
-static BlockID cw_curID;
 static int cw_colR, cw_colG, cw_colB;
 static PackedCol Cw_ParseColor(PackedCol defValue) {
 	int r = cw_colR, g = cw_colG, b = cw_colB;
@@ -704,21 +849,178 @@ static PackedCol Cw_ParseColor(PackedCol defValue) {
 	return PackedCol_Make(r, g, b, 255);
 }
 
-static void Cw_Callback_4(struct NbtTag* tag) {
-	BlockID id = cw_curID;
-	struct LocalPlayer* p = &LocalPlayer_Instances[0];
+static cc_result Cw_ReadColor(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
+
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
+
+		if (IsTag(&tag, "R")) {
+			cw_colR = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "G")) {
+			cw_colG = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "B")) {
+			cw_colB = NbtTag_U16(&tag);
+		}
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
+	}
+}
+
+static cc_result Cw_ReadColors(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
+
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
+		
+		if (Nbt_EnterDict(&tag)) {
+			if ((res = Cw_ReadColor(r))) return res;
+
+			if (IsTag(&tag, "Sky")) {
+				Env.SkyCol    = Cw_ParseColor(ENV_DEFAULT_SKY_COLOR);
+			} else if (IsTag(&tag, "Cloud")) {
+				Env.CloudsCol = Cw_ParseColor(ENV_DEFAULT_CLOUDS_COLOR);
+			} else if (IsTag(&tag, "Fog")) {
+				Env.FogCol    = Cw_ParseColor(ENV_DEFAULT_FOG_COLOR);
+			} else if (IsTag(&tag, "Sunlight")) {
+				Env_SetSunCol(Cw_ParseColor(ENV_DEFAULT_SUN_COLOR));
+			} else if (IsTag(&tag, "Ambient")) {
+				Env_SetShadowCol(Cw_ParseColor(ENV_DEFAULT_SHADOW_COLOR));
+			} else if (IsTag(&tag, "Skybox")) {
+				Env.SkyboxCol = Cw_ParseColor(ENV_DEFAULT_SKYBOX_COLOR);
+			}
+		}
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
+	}
+}
 
-	if (!IsTag(tag->parent->parent, "CPE")) return;
-	if (!IsTag(tag->parent->parent->parent, "Metadata")) return;
+static void Cw_ParseBlockDefProp(struct NbtReader* r, struct NbtTag* tag, BlockID* curID) {
+	cc_uint8 arr[NBT_SMALL_SIZE];
+	BlockID id = *curID;
+	cc_uint8 sound;
+
+	if (IsTag(tag, "ID"))             { *curID = NbtTag_U8(tag);  return; }
+	if (IsTag(tag, "ID2"))            { *curID = NbtTag_U16(tag); return; }
+	if (IsTag(tag, "CollideType"))    { Blocks.Collide[id] = NbtTag_U8(tag); return; }
+	if (IsTag(tag, "Speed"))          { Blocks.SpeedMultiplier[id] = NbtTag_F32(tag); return; }
+	if (IsTag(tag, "TransmitsLight")) { Blocks.BlocksLight[id] = NbtTag_U8(tag) == 0; return; }
+	if (IsTag(tag, "FullBright"))     { Blocks.Brightness[id] = Block_ReadBrightness(NbtTag_U8(tag)); return; }
+	if (IsTag(tag, "BlockDraw"))      { Blocks.Draw[id] = NbtTag_U8(tag); return; }
+	if (IsTag(tag, "Shape"))          { Blocks.SpriteOffset[id] = NbtTag_U8(tag); return; }
+
+	if (IsTag(tag, "Name")) {
+		cc_string name = NbtTag_String(tag);
+		Block_SetName(id, &name);
+		return;
+	}
+
+	if (IsTag(tag, "Textures")) {
+		if (!Nbt_ReadSmallArray(r, tag, arr, 6)) return;
+
+		Block_Tex(id, FACE_YMAX) = arr[0]; Block_Tex(id, FACE_YMIN) = arr[1];
+		Block_Tex(id, FACE_XMIN) = arr[2]; Block_Tex(id, FACE_XMAX) = arr[3];
+		Block_Tex(id, FACE_ZMIN) = arr[4]; Block_Tex(id, FACE_ZMAX) = arr[5];
+
+		/* hacky way of storing upper 8 bits */
+		if (tag->count >= 12) {
+			Block_Tex(id, FACE_YMAX) |= arr[6]  << 8; Block_Tex(id, FACE_YMIN) |= arr[7]  << 8;
+			Block_Tex(id, FACE_XMIN) |= arr[8]  << 8; Block_Tex(id, FACE_XMAX) |= arr[9]  << 8;
+			Block_Tex(id, FACE_ZMIN) |= arr[10] << 8; Block_Tex(id, FACE_ZMAX) |= arr[11] << 8;
+		}
+		return;
+	}
+	
+	if (IsTag(tag, "WalkSound")) {
+		sound = NbtTag_U8(tag);
+		Blocks.DigSounds[id]  = sound;
+		Blocks.StepSounds[id] = sound;
+		if (sound == SOUND_GLASS) Blocks.StepSounds[id] = SOUND_STONE;
+		return;
+	}
+
+	if (IsTag(tag, "Fog")) {
+		if (!Nbt_ReadSmallArray(r, tag, arr, 4)) return;
+
+		Blocks.FogDensity[id] = (arr[0] + 1) / 128.0f;
+		/* Backwards compatibility with apps that use 0xFF to indicate no fog */
+		if (arr[0] == 0 || arr[0] == 0xFF) Blocks.FogDensity[id] = 0.0f;
+		Blocks.FogCol[id] = PackedCol_Make(arr[1], arr[2], arr[3], 255);
+		return;
+	}
+
+	if (IsTag(tag, "Coords")) {
+		if (!Nbt_ReadSmallArray(r, tag, arr, 6)) return;
+
+		Blocks.MinBB[id].x = (cc_int8)arr[0] / 16.0f; Blocks.MaxBB[id].x = (cc_int8)arr[3] / 16.0f;
+		Blocks.MinBB[id].y = (cc_int8)arr[1] / 16.0f; Blocks.MaxBB[id].y = (cc_int8)arr[4] / 16.0f;
+		Blocks.MinBB[id].z = (cc_int8)arr[2] / 16.0f; Blocks.MaxBB[id].z = (cc_int8)arr[5] / 16.0f;
+		return;
+	}
+}
+
+static cc_result Cw_ReadBlockDef(struct NbtReader* r, BlockID* curID) {
+	struct NbtTag tag;
+	cc_result res;
+
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
+
+		Cw_ParseBlockDefProp(r, &tag, curID);
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
+	}
+}
+
+static void Cw_DefineBlock(BlockID id) {
+	/* hack for sprite draw (can't rely on order of tags when reading) */
+	if (Blocks.SpriteOffset[id] == 0) {
+		Blocks.SpriteOffset[id] = Blocks.Draw[id];
+		Blocks.Draw[id] = DRAW_SPRITE;
+	} else {
+		Blocks.SpriteOffset[id] = 0;
+	}
 
-	if (IsTag(tag->parent, "ClickDistance")) {
+	Block_DefineCustom(id, false);
+	Blocks.CanPlace[id]  = true;
+	Blocks.CanDelete[id] = true;
+	Event_RaiseVoid(&BlockEvents.PermissionsChanged);
+}
+
+static cc_result Cw_ReadBlockDefs(struct NbtReader* r) {
+	static const cc_string blockStr = String_FromConst("Block");
+	struct NbtTag tag;
+	BlockID id = 0;
+	cc_result res;
+
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
+
+		if (Nbt_EnterDict(&tag)) {
+			if ((res = Cw_ReadBlockDef(r, &id))) return res;
+
+			if (String_CaselessStarts(&tag.name, &blockStr)) {
+				Cw_DefineBlock(id); id = 0;
+			}
+		}
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
+	}
+}
+
+static void Cw_ParseExtValue(struct NbtTag* ext, struct NbtTag* tag) {
+	struct LocalPlayer* p = &LocalPlayer_Instances[0];
+
+	if (IsTag(ext, "ClickDistance")) {
 		if (IsTag(tag, "Distance")) { p->ReachDistance = NbtTag_U16(tag) / 32.0f; return; }
 	}
-	if (IsTag(tag->parent, "EnvWeatherType")) {
+	if (IsTag(ext, "EnvWeatherType")) {
 		if (IsTag(tag, "WeatherType")) { Env.Weather = NbtTag_U8(tag); return; }
 	}
 
-	if (IsTag(tag->parent, "EnvMapAppearance")) {
+	if (IsTag(ext, "EnvMapAppearance")) {
 		if (IsTag(tag, "SideBlock")) { Env.SidesBlock = NbtTag_U8(tag);  return; }
 		if (IsTag(tag, "EdgeBlock")) { Env.EdgeBlock  = NbtTag_U8(tag);  return; }
 		if (IsTag(tag, "SideLevel")) { Env.EdgeHeight = NbtTag_I16(tag); return; }
@@ -730,7 +1032,7 @@ static void Cw_Callback_4(struct NbtTag* tag) {
 		}
 	}
 
-	if (IsTag(tag->parent, "EnvMapAspect")) {
+	if (IsTag(ext, "EnvMapAspect")) {
 		if (IsTag(tag, "EdgeBlock"))    { Env.EdgeBlock    = NbtTag_U16(tag); return; }
 		if (IsTag(tag, "SideBlock"))    { Env.SidesBlock   = NbtTag_U16(tag); return; }
 		if (IsTag(tag, "EdgeHeight"))   { Env.EdgeHeight   = NbtTag_I32(tag); return; }
@@ -743,142 +1045,94 @@ static void Cw_Callback_4(struct NbtTag* tag) {
 		if (IsTag(tag, "SkyboxHor"))    { Env.SkyboxHorSpeed = NbtTag_F32(tag); return; }
 		if (IsTag(tag, "SkyboxVer"))    { Env.SkyboxVerSpeed = NbtTag_F32(tag); return; }
 	}
+}
 
-	/* Callback for compound tag is called after all its children have been processed */
-	if (IsTag(tag->parent, "EnvColors")) {
-		if (IsTag(tag, "Sky")) {
-			Env.SkyCol    = Cw_ParseColor(ENV_DEFAULT_SKY_COLOR); return;
-		} else if (IsTag(tag, "Cloud")) {
-			Env.CloudsCol = Cw_ParseColor(ENV_DEFAULT_CLOUDS_COLOR); return;
-		} else if (IsTag(tag, "Fog")) {
-			Env.FogCol    = Cw_ParseColor(ENV_DEFAULT_FOG_COLOR); return;
-		} else if (IsTag(tag, "Sunlight")) {
-			Env_SetSunCol(Cw_ParseColor(ENV_DEFAULT_SUN_COLOR)); return;
-		} else if (IsTag(tag, "Ambient")) {
-			Env_SetShadowCol(Cw_ParseColor(ENV_DEFAULT_SHADOW_COLOR)); return;
-		} else if (IsTag(tag, "Skybox")) {
-			Env.SkyboxCol = Cw_ParseColor(ENV_DEFAULT_SKYBOX_COLOR); return;
-		} 
-	}
-
-	if (IsTag(tag->parent, "BlockDefinitions") && Game_AllowCustomBlocks) {
-		static const cc_string blockStr = String_FromConst("Block");
-		if (!String_CaselessStarts(&tag->name, &blockStr)) return;	
-
-		/* hack for sprite draw (can't rely on order of tags when reading) */
-		if (Blocks.SpriteOffset[id] == 0) {
-			Blocks.SpriteOffset[id] = Blocks.Draw[id];
-			Blocks.Draw[id] = DRAW_SPRITE;
-		} else {
-			Blocks.SpriteOffset[id] = 0;
-		}
+static cc_result Cw_ReadExt(struct NbtReader* r, struct NbtTag* ext) {
+	struct NbtTag tag;
+	cc_result res;
+
+	if (IsTag(ext, "EnvColors"))        return Cw_ReadColors(r);
+	if (IsTag(ext, "BlockDefinitions") && Game_AllowCustomBlocks) return Cw_ReadBlockDefs(r);
 
-		Block_DefineCustom(id, false);
-		Blocks.CanPlace[id]  = true;
-		Blocks.CanDelete[id] = true;
-		Event_RaiseVoid(&BlockEvents.PermissionsChanged);
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
 
-		cw_curID = 0;
+		Cw_ParseExtValue(ext, &tag);
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
 }
 
-static void Cw_Callback_5(struct NbtTag* tag) {
-	BlockID id = cw_curID;
-	cc_uint8* arr;
-	cc_uint8 sound;
+static cc_result Cw_ReadCPE(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
 
-	if (!IsTag(tag->parent->parent->parent, "CPE")) return;
-	if (!IsTag(tag->parent->parent->parent->parent, "Metadata")) return;
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
 
-	if (IsTag(tag->parent->parent, "EnvColors")) {
-		if (IsTag(tag, "R")) { cw_colR = NbtTag_U16(tag); return; }
-		if (IsTag(tag, "G")) { cw_colG = NbtTag_U16(tag); return; }
-		if (IsTag(tag, "B")) { cw_colB = NbtTag_U16(tag); return; }
+		if (Nbt_EnterDict(&tag) && (res = Cw_ReadExt(r, &tag))) return res;
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
+}
 
-	if (IsTag(tag->parent->parent, "BlockDefinitions") && Game_AllowCustomBlocks) {
-		if (IsTag(tag, "ID"))             { cw_curID = NbtTag_U8(tag);  return; }
-		if (IsTag(tag, "ID2"))            { cw_curID = NbtTag_U16(tag); return; }
-		if (IsTag(tag, "CollideType"))    { Blocks.Collide[id] = NbtTag_U8(tag); return; }
-		if (IsTag(tag, "Speed"))          { Blocks.SpeedMultiplier[id] = NbtTag_F32(tag); return; }
-		if (IsTag(tag, "TransmitsLight")) { Blocks.BlocksLight[id] = NbtTag_U8(tag) == 0; return; }
-		if (IsTag(tag, "FullBright"))     { Blocks.Brightness[id] = Block_ReadBrightness(NbtTag_U8(tag)); return; }
-		if (IsTag(tag, "BlockDraw"))      { Blocks.Draw[id] = NbtTag_U8(tag); return; }
-		if (IsTag(tag, "Shape"))          { Blocks.SpriteOffset[id] = NbtTag_U8(tag); return; }
-
-		if (IsTag(tag, "Name")) {
-			cc_string name = NbtTag_String(tag);
-			Block_SetName(id, &name);
-			return;
-		}
-
-		if (IsTag(tag, "Textures")) {
-			arr = NbtTag_U8_Array(tag, 6);
-			if (!arr) return;
-
-			Block_Tex(id, FACE_YMAX) = arr[0]; Block_Tex(id, FACE_YMIN) = arr[1];
-			Block_Tex(id, FACE_XMIN) = arr[2]; Block_Tex(id, FACE_XMAX) = arr[3];
-			Block_Tex(id, FACE_ZMIN) = arr[4]; Block_Tex(id, FACE_ZMAX) = arr[5];
-
-			/* hacky way of storing upper 8 bits */
-			if (tag->dataSize >= 12) {
-				Block_Tex(id, FACE_YMAX) |= arr[6]  << 8; Block_Tex(id, FACE_YMIN) |= arr[7]  << 8;
-				Block_Tex(id, FACE_XMIN) |= arr[8]  << 8; Block_Tex(id, FACE_XMAX) |= arr[9]  << 8;
-				Block_Tex(id, FACE_ZMIN) |= arr[10] << 8; Block_Tex(id, FACE_ZMAX) |= arr[11] << 8;
-			}
-			return;
-		}
-		
-		if (IsTag(tag, "WalkSound")) {
-			sound = NbtTag_U8(tag);
-			Blocks.DigSounds[id]  = sound;
-			Blocks.StepSounds[id] = sound;
-			if (sound == SOUND_GLASS) Blocks.StepSounds[id] = SOUND_STONE;
-			return;
-		}
-
-		if (IsTag(tag, "Fog")) {
-			arr = NbtTag_U8_Array(tag, 4);
-			if (!arr) return;
-
-			Blocks.FogDensity[id] = (arr[0] + 1) / 128.0f;
-			/* Backwards compatibility with apps that use 0xFF to indicate no fog */
-			if (arr[0] == 0 || arr[0] == 0xFF) Blocks.FogDensity[id] = 0.0f;
-			Blocks.FogCol[id] = PackedCol_Make(arr[1], arr[2], arr[3], 255);
-			return;
-		}
+static cc_result Cw_ReadMetadata(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
 
-		if (IsTag(tag, "Coords")) {
-			arr = NbtTag_U8_Array(tag, 6);
-			if (!arr) return;
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
 
-			Blocks.MinBB[id].x = (cc_int8)arr[0] / 16.0f; Blocks.MaxBB[id].x = (cc_int8)arr[3] / 16.0f;
-			Blocks.MinBB[id].y = (cc_int8)arr[1] / 16.0f; Blocks.MaxBB[id].y = (cc_int8)arr[4] / 16.0f;
-			Blocks.MinBB[id].z = (cc_int8)arr[2] / 16.0f; Blocks.MaxBB[id].z = (cc_int8)arr[5] / 16.0f;
-			return;
-		}
+		if (IsTag(&tag, "CPE") && Nbt_EnterDict(&tag) && (res = Cw_ReadCPE(r))) return res;
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
 }
 
-static void Cw_Callback(struct NbtTag* tag) {
-	struct NbtTag* tmp = tag->parent;
-	int depth = 0;
-	while (tmp) { depth++; tmp = tmp->parent; }
+static cc_result Cw_ReadRoot(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
+#ifdef EXTENDED_BLOCKS
+	BlockRaw* blocks2;
+#endif
 
-	switch (depth) {
-	case 1: Cw_Callback_1(tag); return;
-	case 2: Cw_Callback_2(tag); return;
-	case 4: Cw_Callback_4(tag); return;
-	case 5: Cw_Callback_5(tag); return;
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
+
+		if (IsTag(&tag, "X")) {
+			World.Width  = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "Y")) {
+			World.Height = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "Z")) {
+			World.Length = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "UUID")) {
+			if (tag.type != NBT_I8S || tag.count != WORLD_UUID_LEN) return CW_ERR_UUID_LEN;
+			if ((res = Nbt_ReadArray(r, &tag, World.Uuid))) return res;
+		} else if (IsTag(&tag, "BlockArray")) {
+			/* Block data is decompressed directly into the world's blocks array */
+			if ((res = Nbt_ReadBigArray(r, &tag, &World.Blocks))) return res;
+			World.Volume = tag.count;
+#ifdef EXTENDED_BLOCKS
+		} else if (IsTag(&tag, "BlockArray2")) {
+			if ((res = Nbt_ReadBigArray(r, &tag, &blocks2))) return res;
+			World_SetMapUpper(blocks2);
+#endif
+		} else if (IsTag(&tag, "MapGenerator") && Nbt_EnterDict(&tag)) {
+			if ((res = Cw_ReadMapGenerator(r))) return res;
+		} else if (IsTag(&tag, "Spawn") && Nbt_EnterDict(&tag)) {
+			if ((res = Cw_ReadSpawn(r))) return res;
+		} else if (IsTag(&tag, "Metadata") && Nbt_EnterDict(&tag)) {
+			if ((res = Cw_ReadMetadata(r))) return res;
+		}
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
-	/* ClassicWorld -> Metadata -> CPE -> ExtName -> [values]
-	        0             1         2        3          4   */
 }
 
 /* Imports a world from a .cw ClassicWorld map file */
 /* Used by ClassiCube/ClassicalSharp */
 static cc_result Cw_Load(struct Stream* stream) {
-	return Nbt_Read(stream, Cw_Callback);
+	return Nbt_Read(stream, Cw_ReadRoot);
 }
 
 
@@ -1399,14 +1653,50 @@ COMPOUND "MinecraftLevel" {
 }*/
 static int mcl_edgeHeight, mcl_sidesHeight;
 
-static void MCLevel_ParseMap(struct NbtTag* tag) {
-	if (IsTag(tag, "width"))  { World.Width  = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "height")) { World.Height = NbtTag_U16(tag); return; }
-	if (IsTag(tag, "length")) { World.Length = NbtTag_U16(tag); return; }
+static cc_result MCLevel_ReadSpawn(struct NbtReader* r, struct NbtTag* list) {
+	struct NbtTag item;
+	cc_int16 value;
+	cc_uint32 i;
+	cc_result res;
+	list->hasData = false;
+
+	for (i = 0; i < list->count; i++) {
+		if ((res = Nbt_ReadItem(r, list, &item))) return res;
+		if (item.hasData && (res = Nbt_SkipData(r, &item))) return res;
+
+		value = NbtTag_I16(&item);
+		if (item.result) return item.result;
+		spawn_point->flags = LU_HAS_POS;
+
+		if (i == 0) spawn_point->pos.x = value;
+		if (i == 1) spawn_point->pos.y = value - 1.0f;
+		if (i == 2) spawn_point->pos.z = value;
+	}
+	return 0;
+}
+
+static cc_result MCLevel_ReadMap(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
 
-	if (IsTag(tag, "blocks")) {
-		World.Volume = tag->dataSize;
-		World.Blocks = Nbt_TakeArray(tag, ".mclevel map blocks");
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
+
+		if (IsTag(&tag, "width")) {
+			World.Width  = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "height")) {
+			World.Height = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "length")) {
+			World.Length = NbtTag_U16(&tag);
+		} else if (IsTag(&tag, "blocks")) {
+			/* Block data is decompressed directly into the world's blocks array */
+			if ((res = Nbt_ReadBigArray(r, &tag, &World.Blocks))) return res;
+			World.Volume = tag.count;
+		} else if (IsTag(&tag, "spawn") && tag.type == NBT_LIST) {
+			if ((res = MCLevel_ReadSpawn(r, &tag))) return res;
+		}
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
 }
 
@@ -1438,47 +1728,40 @@ static void MCLevel_ParseEnvironment(struct NbtTag* tag) {
 	/* TODO: SkyBrightness */
 }
 
+static cc_result MCLevel_ReadEnvironment(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
 
-static void MCLevel_Callback_2(struct NbtTag* tag) {
-	struct NbtTag* group = tag->parent;
-	if (IsTag(group, "Map")) {
-		MCLevel_ParseMap(tag);
-	} else if (IsTag(group, "Environment")) {
-		MCLevel_ParseEnvironment(tag);
-	}
-}
-
-static void MCLevel_Callback_3(struct NbtTag* tag) {
-	struct NbtTag* group = tag->parent->parent;
-	struct NbtTag* field = tag->parent;
-
-	if (IsTag(group, "Map") && IsTag(field, "spawn")) {
-		cc_int16 value     = NbtTag_I16(tag);
-		spawn_point->flags = LU_HAS_POS;
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
 
-		if (tag->listIndex == 0) spawn_point->pos.x = value;
-		if (tag->listIndex == 1) spawn_point->pos.y = value - 1.0f;
-		if (tag->listIndex == 2) spawn_point->pos.z = value;
+		MCLevel_ParseEnvironment(&tag);
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
 }
 
-static void MCLevel_Callback(struct NbtTag* tag) {
-	struct NbtTag* tmp = tag->parent;
-	int depth = 0;
-	while (tmp) { depth++; tmp = tmp->parent; }
+static cc_result MCLevel_ReadRoot(struct NbtReader* r) {
+	struct NbtTag tag;
+	cc_result res;
+
+	for (;;) {
+		if ((res = Nbt_ReadTag(r, &tag))) return res;
+		if (tag.type == NBT_END) return 0;
 
-	switch (depth) {
-	case 2: MCLevel_Callback_2(tag); return;
-	case 3: MCLevel_Callback_3(tag); return;
+		if (IsTag(&tag, "Map") && Nbt_EnterDict(&tag)) {
+			if ((res = MCLevel_ReadMap(r))) return res;
+		} else if (IsTag(&tag, "Environment") && Nbt_EnterDict(&tag)) {
+			if ((res = MCLevel_ReadEnvironment(r))) return res;
+		}
+		if ((res = Nbt_FinishTag(r, &tag))) return res;
 	}
-	/* MinecraftLevel -> Map/Environment -> [value]
-			0					1				 2 */
 }
 
 /* Imports a world from a .mclevel NBT map file */
 /* Used by Minecraft Indev client */
 static cc_result MCLevel_Load(struct Stream* stream) {
-	cc_result res = Nbt_Read(stream, MCLevel_Callback);
+	cc_result res = Nbt_Read(stream, MCLevel_ReadRoot);
 
 	Env.EdgeHeight  = mcl_edgeHeight;
 	Env.SidesOffset = mcl_sidesHeight - mcl_edgeHeight;
@@ -1574,12 +1857,11 @@ static cc_result Cw_WriteBockDef(struct Stream* stream, int b) {
 	return Stream_Write(stream, buffer, (int)(cur - buffer));
 }
 
-cc_result Cw_Save(struct Stream* stream) {
+/* Writes everything before the blocks data */
+static cc_result Cw_WriteHeader(struct Stream* stream) {
 	struct LocalPlayer* p = Entities.CurPlayer;
-	cc_uint8 buffer[2048];
+	cc_uint8 buffer[512];
 	cc_uint8* cur;
-	cc_result res;
-	int b;
 
 	cur = buffer;
 	cur = Nbt_WriteDict(cur,   "ClassicWorld");
@@ -1604,20 +1886,23 @@ cc_result Cw_Save(struct Stream* stream) {
 		cur  = Nbt_WriteUInt8(cur,  "H", Math_Deg2Packed(p->SpawnYaw));
 		cur  = Nbt_WriteUInt8(cur,  "P", Math_Deg2Packed(p->SpawnPitch));
 	} *cur++ = NBT_END;
-	cur = Nbt_WriteArray(cur, "BlockArray", World.Volume);
 
-	if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
-	if ((res = Stream_Write(stream, World.Blocks, World.Volume)))  return res;
+	return Stream_Write(stream, buffer, (int)(cur - buffer));
+}
 
-#ifdef EXTENDED_BLOCKS
-	if (World.Blocks != World.Blocks2) {
-		cur = buffer;
-		cur = Nbt_WriteArray(cur, "BlockArray2", World.Volume);
+static cc_result Cw_WriteArrayHeader(struct Stream* stream, const char* name, cc_uint32 volume) {
+	cc_uint8 buffer[64];
+	cc_uint8* cur = Nbt_WriteArray(buffer, name, volume);
+	return Stream_Write(stream, buffer, (int)(cur - buffer));
+}
 
-		if ((res = Stream_Write(stream, buffer, (int)(cur - buffer)))) return res;
-		if ((res = Stream_Write(stream, World.Blocks2, World.Volume))) return res;
-	}
-#endif
+/* Writes everything after the blocks data */
+static cc_result Cw_WriteMetadata(struct Stream* stream) {
+	struct LocalPlayer* p = Entities.CurPlayer;
+	cc_uint8 buffer[2048];
+	cc_uint8* cur;
+	cc_result res;
+	int b;
 
 	cur = buffer;
 	cur = Nbt_WriteDict(cur, "Metadata");
@@ -1681,6 +1966,888 @@ cc_result Cw_Save(struct Stream* stream) {
 	return Stream_Write(stream, cw_end, sizeof(cw_end));
 }
 
+cc_result Cw_Save(struct Stream* stream) {
+	cc_result res;
+	if ((res = Cw_WriteHeader(stream)))                                  return res;
+	if ((res = Cw_WriteArrayHeader(stream, "BlockArray", World.Volume))) return res;
+	if ((res = Stream_Write(stream, World.Blocks, World.Volume)))        return res;
+
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) {
+		if ((res = Cw_WriteArrayHeader(stream, "BlockArray2", World.Volume))) return res;
+		if ((res = Stream_Write(stream, World.Blocks2, World.Volume)))        return res;
+	}
+#endif
+	return Cw_WriteMetadata(stream);
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------Background ClassicWorld export--------------------------------------------*
+*#########################################################################################################################*/
+#ifndef CC_BUILD_COOPTHREADED
+#define CW_SAVE_META_SIZE (16 * 1024)
+
+static struct CwBackgroundSave {
+	void* thread;
+	struct Stream file, comp;
+	struct GZipState* gzip;
+	struct Stream meta;   /* Metadata, captured into memory when the save began */
+	BlockRaw* page;       /* Temp buffer for blocks read from the world snapshot */
+	cc_uint32 volume;
+	cc_bool upper;
+	cc_result result;
+	cc_filepath path, tmpPath;
+	cc_string name; char nameBuffer[FILENAME_SIZE];
+} cw_save;
+volatile static cc_bool cw_saveDone;
+volatile static float cw_saveProgress;
+static struct ScheduledTask2 cw_saveTask;
+
+static cc_result CwSave_WriteBlocks(cc_bool upper) {
+	cc_uint32 offset, count, total = cw_save.upper ? cw_save.volume * 2 : cw_save.volume;
+	cc_uint32 done = upper ? cw_save.volume : 0;
+	cc_result res;
+
+	for (offset = 0; offset < cw_save.volume; offset += WORLD_SNAPSHOT_PAGE_SIZE) {
+		count = min(WORLD_SNAPSHOT_PAGE_SIZE, cw_save.volume - offset);
+		if ((res = World_ReadSnapshot(offset, count, upper, cw_save.page))) return res;
+		if ((res = Stream_Write(&cw_save.comp, cw_save.page, count)))       return res;
+
+		cw_saveProgress = (float)(done + offset + count) / total;
+	}
+	return 0;
+}
+
+static cc_result CwSave_WriteAll(void) {
+	struct Stream* meta = &cw_save.meta;
+	cc_result res;
+	if ((res = CwSave_WriteBlocks(false))) return res;
+
+	if (cw_save.upper) {
+		res = Cw_WriteArrayHeader(&cw_save.comp, "BlockArray2", cw_save.volume);
+		if (res) return res;
+		if ((res = CwSave_WriteBlocks(true))) return res;
+	}
+
+	res = Stream_Write(&cw_save.comp, meta->meta.mem.base, Map_MemWriterLength(meta));
+	if (res) return res;
+	return cw_save.comp.Close(&cw_save.comp);
+}
+
+static void CwSave_Run(void) {
+	cc_result res = CwSave_WriteAll();
+	cc_result closeRes = cw_save.file.Close(&cw_save.file);
+	if (!res) res = closeRes;
+
+	/* Only replace the existing map file once the new one has been completely written */
+	if (!res) res = File_Rename(&cw_save.tmpPath, &cw_save.path);
+	if (res)  File_Delete(&cw_save.tmpPath);
+	cw_save.result = res;
+	cw_saveDone    = true;
+}
+
+static void CwSave_Free(void) {
+	Mem_Free(cw_save.gzip);
+	Mem_Free(cw_save.page);
+	Mem_Free(cw_save.meta.meta.mem.base);
+
+	cw_save.gzip = NULL;
+	cw_save.page = NULL;
+	cw_save.meta.meta.mem.base = NULL;
+}
+
+static cc_result CwSave_Begin(void) {
+	cc_result res;
+	cw_save.gzip = (struct GZipState*)Mem_TryAlloc(1, sizeof(struct GZipState));
+	cw_save.page = (BlockRaw*)Mem_TryAlloc(WORLD_SNAPSHOT_PAGE_SIZE, 1);
+
+	if ((res = Map_OpenMemWriter(&cw_save.meta, CW_SAVE_META_SIZE))) return res;
+	if (!cw_save.gzip || !cw_save.page) return ERR_OUT_OF_MEMORY;
+
+	res = Stream_CreatePath(&cw_save.file, &cw_save.tmpPath);
+	if (res) { Logger_IOWarn2(res, "creating", &cw_save.tmpPath); return res; }
+	GZip_MakeStream(&cw_save.comp, cw_save.gzip, &cw_save.file);
+
+	/* Everything except for the blocks is written or captured on the main thread */
+	res = Cw_WriteHeader(&cw_save.comp);
+	if (!res) res = Cw_WriteArrayHeader(&cw_save.comp, "BlockArray", World.Volume);
+	if (!res) res = Cw_WriteMetadata(&cw_save.meta);
+
+	if (res) {
+		cw_save.file.Close(&cw_save.file);
+		File_Delete(&cw_save.tmpPath);
+		Logger_IOWarn2(res, "encoding", &cw_save.tmpPath); return res;
+	}
+
+	if (!World_BeginSnapshot()) {
+		cw_save.file.Close(&cw_save.file);
+		File_Delete(&cw_save.tmpPath);
+		return ERR_OUT_OF_MEMORY;
+	}
+	return 0;
+}
+
+cc_result Cw_SaveInBackground(const cc_string* path) {
+	cc_string tmpPath; char tmpBuffer[FILENAME_SIZE];
+	cc_result res;
+	if (cw_save.thread) return ERR_INVALID_ARGUMENT;
+
+	String_InitArray(tmpPath, tmpBuffer);
+	String_Format1(&tmpPath, "%s.tmp", path);
+	Platform_EncodePath(&cw_save.path,    path);
+	Platform_EncodePath(&cw_save.tmpPath, &tmpPath);
+
+	String_InitArray(cw_save.name, cw_save.nameBuffer);
+	String_Copy(&cw_save.name, path);
+
+	if ((res = CwSave_Begin())) {
+		if (res == ERR_OUT_OF_MEMORY) Logger_SysWarn(res, "allocating background save memory");
+		CwSave_Free(); return res;
+	}
+
+	cw_save.volume = World.Volume;
+	cw_save.upper  = false;
+#ifdef EXTENDED_BLOCKS
+	cw_save.upper  = World.Blocks != World.Blocks2;
+#endif
+	cw_saveDone     = false;
+	cw_saveProgress = 0.0f;
+
+	Thread_Run(&cw_save.thread, CwSave_Run, 128 * 1024, "Map save");
+	return 0;
+}
+
+cc_bool Cw_IsSavingInBackground(void) { return cw_save.thread != NULL; }
+
+static cc_result CwSave_Finish(void) {
+	Thread_Join(cw_save.thread);
+	cw_save.thread = NULL;
+
+	World_EndSnapshot();
+	CwSave_Free();
+	return cw_save.result;
+}
+
+static cc_bool CwSave_Tick(struct ScheduledTask2* task) {
+	cc_result res;
+	if (!cw_save.thread) return true;
+
+	if (!cw_saveDone) {
+		Event_RaiseFloat(&WorldEvents.Saving, cw_saveProgress);
+		return true;
+	}
+
+	res = CwSave_Finish();
+	if (res) { Logger_IOWarn2(res, "saving", &cw_save.tmpPath); return true; }
+
+	World.LastSave = Game.Time;
+	Event_RaiseFloat(&WorldEvents.Saving, 1.0f);
+	Chat_Add1("&eSaved map to: %s", &cw_save.name);
+	CPE_SendNotifyAction(NOTIFY_ACTION_LEVEL_SAVED, 0);
+	return true;
+}
+
+static void CwSave_Init(void) {
+	cw_saveTask.interval = 0.1f;
+	cw_saveTask.callback = CwSave_Tick;
+	ScheduledTask2_Add(&cw_saveTask);
+}
+
+static void CwSave_Shutdown(void) {
+	/* Make sure the save is completed before exiting */
+	cc_result res;
+	if (!cw_save.thread) return;
+
+	res = CwSave_Finish();
+	if (res) Logger_IOWarn2(res, "saving", &cw_save.tmpPath);
+}
+#else
+cc_result Cw_SaveInBackground(const cc_string* path) { return ERR_NOT_SUPPORTED; }
+cc_bool Cw_IsSavingInBackground(void) { return false; }
+
+static void CwSave_Init(void)     { }
+static void CwSave_Shutdown(void) { }
+#endif
+
+
+/*########################################################################################################################*
+*--------------------------------------------------Fast load map cache----------------------------------------------------*
+*#########################################################################################################################*/
+/* Fast load cache is an uncompressed copy of a .cw map, stored in a separate file alongside the map file.
+	U8[4] "Identifier" ("CCFL")
+	U32   "Version"    (MAPCACHE_VERSION)
+	U32   "Length"     (length of the map file)
+	U32   "CRC32"      (CRC32 of the map file's contents)
+	...   "Data"       (ClassicWorld NBT data, not GZIP compressed)
+}*/
+#define MAPCACHE_VERSION 1
+#define MAPCACHE_HEADER_SIZE 16
+static const cc_uint8 mapCache_ident[4] = { 'C', 'C', 'F', 'L' };
+
+static void MapCache_GetPath(cc_string* cachePath, const cc_string* path) {
+	String_Format1(cachePath, "%s.fastload", path);
+}
+
+/* Calculates the length and CRC32 of the given map file's contents */
+static cc_result MapCache_HashFile(const cc_string* path, cc_uint32* length, cc_uint32* crc32) {
+	cc_uint8 buffer[8192];
+	struct Stream stream;
+	cc_filepath raw_path;
+	cc_uint32 i, read, crc = 0xFFFFFFFFUL;
+	cc_result res;
+
+	*length = 0;
+	Platform_EncodePath(&raw_path, path);
+	if ((res = Stream_OpenPath(&stream, &raw_path))) return res;
+
+	for (;;) {
+		res = stream.Read(&stream, buffer, sizeof(buffer), &read);
+		if (res || !read) break;
+
+		for (i = 0; i < read; i++) {
+			crc = Utils_Crc32Table[(crc ^ buffer[i]) & 0xFF] ^ (crc >> 8);
+		}
+		*length += read;
+	}
+
+	*crc32 = crc ^ 0xFFFFFFFFUL;
+	(void)stream.Close(&stream);
+	return res;
+}
+
+static cc_result MapCache_FileLength(const cc_string* path, cc_uint32* length) {
+	struct Stream stream;
+	cc_filepath raw_path;
+	cc_result res;
+
+	Platform_EncodePath(&raw_path, path);
+	if ((res = Stream_OpenPath(&stream, &raw_path))) return res;
+
+	res = stream.Length(&stream, length);
+	(void)stream.Close(&stream);
+	return res;
+}
+
+static cc_result MapCache_ReadHeader(struct Stream* stream, const cc_string* path) {
+	cc_uint8 header[MAPCACHE_HEADER_SIZE];
+	cc_uint32 length, crc32;
+	cc_result res;
+
+	if ((res = Stream_Read(stream, header, MAPCACHE_HEADER_SIZE))) return res;
+	if (!Mem_Equal(header, mapCache_ident, sizeof(mapCache_ident))) return MAP_ERR_CACHE_STALE;
+	if (Mem_ReadU32_LE(&header[4]) != MAPCACHE_VERSION)             return MAP_ERR_CACHE_STALE;
+
+	/* Cache is only valid if map file hasn't been changed since the cache was made */
+	/* Checking the length first avoids hashing the whole map file when it has obviously changed */
+	if ((res = MapCache_FileLength(path, &length))) return res;
+	if (Mem_ReadU32_LE(&header[8])  != length) return MAP_ERR_CACHE_STALE;
+
+	if ((res = MapCache_HashFile(path, &length, &crc32))) return res;
+	if (Mem_ReadU32_LE(&header[8])  != length) return MAP_ERR_CACHE_STALE;
+	if (Mem_ReadU32_LE(&header[12]) != crc32)  return MAP_ERR_CACHE_STALE;
+	return 0;
+}
+
+cc_result Map_LoadCache(const cc_string* path) {
+	cc_string cachePath; char cacheBuffer[FILENAME_SIZE];
+	struct Stream stream;
+	cc_filepath raw_path;
+	cc_result res;
+
+	String_InitArray(cachePath, cacheBuffer);
+	MapCache_GetPath(&cachePath, path);
+	Platform_EncodePath(&raw_path, &cachePath);
+
+	if (!File_Exists(&raw_path)) return ReturnCode_FileNotFound;
+	if ((res = Stream_OpenPath(&stream, &raw_path))) return res;
+
+	res = MapCache_ReadHeader(&stream, path);
+	/* Since the data isn't compressed, block arrays are read directly from the file */
+	if (!res) res = Nbt_ReadRoot(&stream, Cw_ReadRoot);
+	
+	/* No point logging error for closing readonly file */
+	(void)stream.Close(&stream);
+	if (!res) return 0;
+
+	if (res == MAP_ERR_CACHE_STALE) return res;
+	Logger_IOWarn2(res, "decoding", &raw_path);
+
+	/* Cache may have been partially loaded, so undo any env or block definition changes */
+	Game_Reset();
+	return res;
+}
+
+cc_result Map_SaveCache(const cc_string* path) {
+	cc_string cachePath; char cacheBuffer[FILENAME_SIZE];
+	cc_uint8 header[MAPCACHE_HEADER_SIZE];
+	cc_uint32 length, crc32;
+	struct Stream stream;
+	cc_filepath raw_path;
+	cc_result res;
+
+	String_InitArray(cachePath, cacheBuffer);
+	MapCache_GetPath(&cachePath, path);
+	Platform_EncodePath(&raw_path, &cachePath);
+
+	res = MapCache_HashFile(path, &length, &crc32);
+	if (res) { Logger_IOWarn2(res, "hashing", &raw_path); return res; }
+
+	Mem_Copy(header, mapCache_ident, sizeof(mapCache_ident));
+	Mem_WriteU32_LE(&header[4],  MAPCACHE_VERSION);
+	Mem_WriteU32_LE(&header[8],  length);
+	Mem_WriteU32_LE(&header[12], crc32);
+
+	res = Stream_CreatePath(&stream, &raw_path);
+	if (res) { Logger_IOWarn2(res, "creating", &raw_path); return res; }
+
+	if (!(res = Stream_Write(&stream, header, MAPCACHE_HEADER_SIZE))) {
+		res = Cw_Save(&stream);
+	}
+	if (res) { 
+		stream.Close(&stream);
+		Logger_IOWarn2(res, "encoding", &raw_path); return res;
+	}
+
+	res = stream.Close(&stream);
+	if (res) { Logger_IOWarn2(res, "closing", &raw_path); return res; }
+	return 0;
+}
+
+
+/*########################################################################################################################*
+*---------------------------------------------------ClassiCube region map-------------------------------------------------*
+*#########################################################################################################################*/
+/* Region maps store blocks in independently DEFLATE compressed regions, allowing random access to regions,
+   decompressing regions in parallel when loading, and only rewriting changed regions when saving.
+	U8[4] "Identifier"   ("CCRM")
+	U16   "Version"      (CCR_VERSION)
+	U16   "Width", "Height", "Length"
+	U8    "RegionShift"  (log2 of region size, e.g. 5 for 32x32x32 regions)
+	U8    "Flags"        (CCR_FLAG_UPPER if upper 8 bits of blocks are stored)
+	U16   "Reserved"
+	U32   "RegionsCount"
+	U32   "MetaOffset", "MetaLength" (DEFLATE compressed ClassicWorld NBT, without the block arrays)
+	U32   "Reserved"
+	REGION "Regions" [RegionsCount] {
+		U32 "Offset", "Length" (of DEFLATE compressed region data, 0 length for unused)
+		U32 "CRC32"            (of uncompressed region data)
+	}
+	...   "Data"         (compressed metadata and regions, in any order)
+Regions are ordered by Y, then Z, then X. Region data is the region's blocks (clipped to the map) in YZX order,
+followed by the upper 8 bits of the region's blocks in YZX order if CCR_FLAG_UPPER is set.
+Changed regions are appended to the end of the file when saving, so the file is occasionally compacted.
+}*/
+#define CCR_VERSION 1
+#define CCR_HEADER_SIZE 32
+#define CCR_ENTRY_SIZE  12
+#define CCR_REGION_SHIFT 5
+#define CCR_FLAG_UPPER 0x01
+static const cc_uint8 ccr_ident[4] = { 'C', 'C', 'R', 'M' };
+
+static struct CcrState {
+	int width, height, length, shift;
+	int regionsX, regionsY, regionsZ, count;
+	cc_bool upper;
+	cc_bool compressAll;    /* Whether to compress regions even if they are unchanged */
+	cc_uint8* table;        /* Offset, length, and CRC32 of each region */
+	cc_uint8* data;         /* Contents of the entire map file when loading */
+	cc_uint32 dataLength;
+	struct Stream* regions; /* Compressed data of each changed region when saving */
+	cc_result* results;     /* Error from decompressing/compressing each region */
+} ccr;
+
+static void Ccr_InitLayout(int width, int height, int length, int shift, cc_bool upper) {
+	int size = 1 << shift;
+	ccr.width  = width;  ccr.height = height; ccr.length = length;
+	ccr.shift  = shift;  ccr.upper  = upper;
+
+	ccr.regionsX = (width  + (size - 1)) >> shift;
+	ccr.regionsY = (height + (size - 1)) >> shift;
+	ccr.regionsZ = (length + (size - 1)) >> shift;
+	ccr.count    = ccr.regionsX * ccr.regionsY * ccr.regionsZ;
+}
+
+/* Processes all the regions in parallel, then returns the first error from any region */
+static cc_result Ccr_ForEachRegion(Utils_ParallelFunc func) {
+	cc_result res = 0;
+	int i;
+
+	ccr.results = (cc_result*)Mem_TryAllocCleared(ccr.count, sizeof(cc_result));
+	if (!ccr.results) return ERR_OUT_OF_MEMORY;
+	Utils_ParallelFor(ccr.count, func, NULL);
+
+	for (i = 0; i < ccr.count && !res; i++) 
+	{
+		res = ccr.results[i];
+	}
+	Mem_Free(ccr.results);
+	ccr.results = NULL;
+	return res;
+}
+
+/* Calculates the origin and size of the given region, returning its number of blocks */
+static int Ccr_GetRegion(int index, int* x, int* y, int* z, int* width, int* height, int* length) {
+	int size = 1 << ccr.shift;
+	*x = (index % ccr.regionsX) << ccr.shift; index /= ccr.regionsX;
+	*z = (index % ccr.regionsZ) << ccr.shift; index /= ccr.regionsZ;
+	*y = index << ccr.shift;
+
+	*width  = min(size, ccr.width  - *x);
+	*height = min(size, ccr.height - *y);
+	*length = min(size, ccr.length - *z);
+	return (*width) * (*height) * (*length);
+}
+
+/* Copies a region's blocks between the world and a region data buffer */
+static void Ccr_CopyRegion(int index, cc_uint8* data, cc_bool toWorld) {
+	int x, y, z, width, height, length, volume;
+	int yy, zz;
+	cc_uint32 i;
+	volume = Ccr_GetRegion(index, &x, &y, &z, &width, &height, &length);
+
+	for (yy = y; yy < y + height; yy++)
+		for (zz = z; zz < z + length; zz++)
+		{
+			i = World_Pack(x, yy, zz);
+			if (toWorld) {
+				Mem_Copy(World.Blocks + i, data, width);
+			} else {
+				Mem_Copy(data, World.Blocks + i, width);
+			}
+
+#ifdef EXTENDED_BLOCKS
+			if (!ccr.upper) { data += width; continue; }
+
+			if (toWorld) {
+				Mem_Copy(World.Blocks2 + i, data + volume, width);
+			} else {
+				Mem_Copy(data + volume, World.Blocks2 + i, width);
+			}
+#endif
+			data += width;
+		}
+}
+
+static cc_uint32 Ccr_RegionDataSize(int index) {
+	int x, y, z, width, height, length;
+	int volume = Ccr_GetRegion(index, &x, &y, &z, &width, &height, &length);
+	return ccr.upper ? volume * 2 : volume;
+}
+
+static cc_result Ccr_ReadHeader(const cc_uint8* header) {
+	int shift = header[12];
+	if (!Mem_Equal(header, ccr_ident, sizeof(ccr_ident)))  return CCR_ERR_INVALID_HDR;
+	if (Mem_ReadU16_LE(&header[4]) != CCR_VERSION)         return CCR_ERR_INVALID_HDR;
+	if (shift < 4 || shift > 8)                            return CCR_ERR_INVALID_HDR;
+
+	Ccr_InitLayout(Mem_ReadU16_LE(&header[6]), Mem_ReadU16_LE(&header[8]), Mem_ReadU16_LE(&header[10]),
+					shift, header[13] & CCR_FLAG_UPPER);
+
+	if (!World_CheckVolume(ccr.width, ccr.height, ccr.length)) return CCR_ERR_INVALID_HDR;
+	if (Mem_ReadU32_LE(&header[16]) != ccr.count)              return CCR_ERR_INVALID_HDR;
+	return 0;
+}
+
+static void Ccr_WriteHeader(cc_uint8* header, cc_uint32 metaOffset, cc_uint32 metaLength) {
+	Mem_Set(header, 0, CCR_HEADER_SIZE);
+	Mem_Copy(header, ccr_ident, sizeof(ccr_ident));
+	Mem_WriteU16_LE(&header[4],  CCR_VERSION);
+	Mem_WriteU16_LE(&header[6],  ccr.width);
+	Mem_WriteU16_LE(&header[8],  ccr.height);
+	Mem_WriteU16_LE(&header[10], ccr.length);
+
+	header[12] = ccr.shift;
+	header[13] = ccr.upper ? CCR_FLAG_UPPER : 0;
+	Mem_WriteU32_LE(&header[16], ccr.count);
+	Mem_WriteU32_LE(&header[20], metaOffset);
+	Mem_WriteU32_LE(&header[24], metaLength);
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------Region map import-------------------------------------------------------*
+*#########################################################################################################################*/
+/* Returns a read only stream over the given compressed data in the map file */
+static cc_result Ccr_OpenData(struct Stream* stream, cc_uint32 offset, cc_uint32 length) {
+	if (offset > ccr.dataLength || length > ccr.dataLength - offset) return CCR_ERR_REGION_DATA;
+
+	Stream_ReadonlyMemory(stream, ccr.data + offset, length);
+	return 0;
+}
+
+static void Ccr_LoadRegion(int index) {
+	cc_uint8* entry = ccr.table + index * CCR_ENTRY_SIZE;
+	cc_uint32 size  = Ccr_RegionDataSize(index);
+	struct InflateState* inflate;
+	struct Stream mem, stream;
+	cc_uint8* data;
+	cc_result res;
+
+	inflate = (struct InflateState*)Mem_TryAlloc(1, sizeof(struct InflateState));
+	data    = (cc_uint8*)Mem_TryAlloc(size, 1);
+
+	if (!inflate || !data) {
+		res = ERR_OUT_OF_MEMORY;
+	} else if (!(res = Ccr_OpenData(&mem, Mem_ReadU32_LE(&entry[0]), Mem_ReadU32_LE(&entry[4])))) {
+		Inflate_MakeStream2(&stream, inflate, &mem);
+		res = Stream_Read(&stream, data, size);
+
+		if (res == ERR_END_OF_STREAM || (!res && Utils_CRC32(data, size) != Mem_ReadU32_LE(&entry[8]))) {
+			res = CCR_ERR_REGION_DATA;
+		}
+	}
+
+	if (res) {
+		ccr.results[index] = res;
+	} else {
+		Ccr_CopyRegion(index, data, true);
+	}
+	Mem_Free(inflate);
+	Mem_Free(data);
+}
+
+static cc_result Ccr_LoadMetadata(void) {
+	struct InflateState state;
+	struct Stream mem, stream;
+	cc_uint8* header = ccr.data;
+	cc_result res;
+
+	res = Ccr_OpenData(&mem, Mem_ReadU32_LE(&header[20]), Mem_ReadU32_LE(&header[24]));
+	if (res) return res;
+
+	Inflate_MakeStream2(&stream, &state, &mem);
+	return Nbt_ReadRoot(&stream, Cw_ReadRoot);
+}
+
+static cc_result Ccr_Decode(void) {
+	cc_uint32 tableSize;
+	cc_result res;
+#ifdef EXTENDED_BLOCKS
+	BlockRaw* blocks2;
+#endif
+
+	if (ccr.dataLength < CCR_HEADER_SIZE) return CCR_ERR_INVALID_HDR;
+	if ((res = Ccr_ReadHeader(ccr.data))) return res;
+
+	tableSize = ccr.count * CCR_ENTRY_SIZE;
+	if (tableSize > ccr.dataLength - CCR_HEADER_SIZE) return CCR_ERR_INVALID_HDR;
+	ccr.table = ccr.data + CCR_HEADER_SIZE;
+
+	if ((res = Ccr_LoadMetadata())) return res;
+	/* Region map's header is the authoritative source of the map's dimensions */
+	World.Width  = ccr.width;
+	World.Height = ccr.height;
+	World.Length = ccr.length;
+	World.Volume = ccr.width * ccr.height * ccr.length;
+
+	World.Blocks = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
+	if (!World.Blocks) return ERR_OUT_OF_MEMORY;
+
+#ifdef EXTENDED_BLOCKS
+	if (ccr.upper) {
+		blocks2 = (BlockRaw*)Mem_TryAlloc(World.Volume, 1);
+		if (!blocks2) return ERR_OUT_OF_MEMORY;
+		World_SetMapUpper(blocks2);
+	}
+#endif
+
+	/* Each region is independently compressed, so they can be decompressed in parallel */
+	return Ccr_ForEachRegion(Ccr_LoadRegion);
+}
+
+/* Imports a world from a .ccr ClassiCube region map file */
+static cc_result Ccr_Load(struct Stream* stream) {
+	cc_uint32 length;
+	cc_result res;
+	if ((res = stream->Length(stream, &length))) return res;
+
+	ccr.data = (cc_uint8*)Mem_TryAlloc(length, 1);
+	if (!ccr.data) return ERR_OUT_OF_MEMORY;
+	ccr.dataLength = length;
+
+	res = Stream_Read(stream, ccr.data, length);
+	if (!res) res = Ccr_Decode();
+
+	Mem_Free(ccr.data);
+	ccr.data  = NULL;
+	ccr.table = NULL;
+	return res;
+}
+
+
+/*########################################################################################################################*
+*-------------------------------------------------Region map export-------------------------------------------------------*
+*#########################################################################################################################*/
+#define CCR_REGION_BUFFER_SIZE 4096
+#define CCR_META_BUFFER_SIZE   (16 * 1024)
+
+static cc_result Ccr_CompressRegion(struct Stream* dst, cc_uint8* data, cc_uint32 size) {
+	struct DeflateState* state;
+	struct Stream comp;
+	cc_result res;
+
+	state = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+	if (!state) return ERR_OUT_OF_MEMORY;
+	if ((res = Map_OpenMemWriter(dst, CCR_REGION_BUFFER_SIZE))) { Mem_Free(state); return res; }
+
+	Deflate_MakeStream(&comp, state, dst);
+	res = Stream_Write(&comp, data, size);
+	if (!res) res = comp.Close(&comp);
+
+	Mem_Free(state);
+	return res;
+}
+
+static void Ccr_SaveRegion(int index) {
+	cc_uint8* entry = ccr.table + index * CCR_ENTRY_SIZE;
+	cc_uint32 size  = Ccr_RegionDataSize(index);
+	cc_uint32 crc32;
+	cc_uint8* data;
+	cc_result res;
+	/* Already compressed in an earlier pass */
+	if (ccr.regions[index].meta.mem.base) return;
+
+	data = (cc_uint8*)Mem_TryAlloc(size, 1);
+	if (!data) { ccr.results[index] = ERR_OUT_OF_MEMORY; return; }
+
+	Ccr_CopyRegion(index, data, false);
+	crc32 = Utils_CRC32(data, size);
+
+	/* Region is unchanged from the version already in the map file */
+	if (!ccr.compressAll && Mem_ReadU32_LE(&entry[4]) && Mem_ReadU32_LE(&entry[8]) == crc32) {
+		Mem_Free(data); return;
+	}
+
+	res = Ccr_CompressRegion(&ccr.regions[index], data, size);
+	if (res) ccr.results[index] = res;
+
+	Mem_WriteU32_LE(&entry[8], crc32);
+	Mem_Free(data);
+}
+
+static cc_result Ccr_SaveMetadata(struct Stream* dst) {
+	struct Stream comp;
+	struct DeflateState* state;
+	cc_result res;
+
+	state = (struct DeflateState*)Mem_TryAlloc(1, sizeof(struct DeflateState));
+	if (!state) return ERR_OUT_OF_MEMORY;
+	if ((res = Map_OpenMemWriter(dst, CCR_META_BUFFER_SIZE))) { Mem_Free(state); return res; }
+
+	Deflate_MakeStream(&comp, state, dst);
+	res = Cw_WriteHeader(&comp);
+	if (!res) res = Cw_WriteMetadata(&comp);
+	if (!res) res = comp.Close(&comp);
+
+	Mem_Free(state);
+	return res;
+}
+
+/* Reads the header and region table of the existing map file, if it is compatible with the world */
+static cc_bool Ccr_ReadExisting(struct Stream* stream, cc_uint32* metaLength) {
+	cc_uint8 header[CCR_HEADER_SIZE];
+	cc_uint8 expected[CCR_HEADER_SIZE];
+	cc_uint32 length = ccr.count * CCR_ENTRY_SIZE;
+
+	if (Stream_Read(stream, header, CCR_HEADER_SIZE)) return false;
+	Ccr_WriteHeader(expected, 0, 0);
+	/* Dimensions, region size, and flags must all match */
+	if (!Mem_Equal(header, expected, 20)) return false;
+
+	*metaLength = Mem_ReadU32_LE(&header[24]);
+	return Stream_Read(stream, ccr.table, length) == 0;
+}
+
+/* Calculates how many bytes in the map file are used by the current regions and metadata */
+static cc_uint32 Ccr_LiveLength(cc_uint32 metaLength) {
+	cc_uint32 total = CCR_HEADER_SIZE + ccr.count * CCR_ENTRY_SIZE + metaLength;
+	int i;
+
+	for (i = 0; i < ccr.count; i++) 
+	{
+		total += Mem_ReadU32_LE(&ccr.table[i * CCR_ENTRY_SIZE + 4]);
+	}
+	return total;
+}
+
+/* Calculates how many bytes of the current regions in the map file would become unused */
+static cc_uint32 Ccr_ReplacedLength(void) {
+	cc_uint32 total = 0;
+	int i;
+
+	for (i = 0; i < ccr.count; i++) 
+	{
+		if (!ccr.regions[i].meta.mem.base) continue;
+		total += Mem_ReadU32_LE(&ccr.table[i * CCR_ENTRY_SIZE + 4]);
+	}
+	return total;
+}
+
+/* Writes compressed regions and metadata starting at the given offset in the file, updating the region table */
+static cc_result Ccr_WriteData(struct Stream* stream, cc_uint32 offset, struct Stream* meta, cc_uint8* header) {
+	cc_uint8* entry;
+	cc_uint32 length;
+	cc_result res;
+	int i;
+
+	for (i = 0; i < ccr.count; i++) 
+	{
+		if (!ccr.regions[i].meta.mem.base) continue;
+		entry  = ccr.table + i * CCR_ENTRY_SIZE;
+		length = Map_MemWriterLength(&ccr.regions[i]);
+
+		if ((res = Stream_Write(stream, ccr.regions[i].meta.mem.base, length))) return res;
+		Mem_WriteU32_LE(&entry[0], offset);
+		Mem_WriteU32_LE(&entry[4], length);
+		offset += length;
+	}
+
+	length = Map_MemWriterLength(meta);
+	if ((res = Stream_Write(stream, meta->meta.mem.base, length))) return res;
+	Ccr_WriteHeader(header, offset, length);
+	return 0;
+}
+
+static cc_result Ccr_WriteTable(struct Stream* stream, cc_uint8* header) {
+	cc_result res;
+	if ((res = Stream_Write(stream, header, CCR_HEADER_SIZE))) return res;
+	return Stream_Write(stream, ccr.table, ccr.count * CCR_ENTRY_SIZE);
+}
+
+/* Rewrites the entire map file, which removes any no longer used data */
+static cc_result Ccr_WriteAll(const cc_string* path, struct Stream* meta) {
+	cc_string tmpPath; char tmpBuffer[FILENAME_SIZE];
+	cc_filepath raw_path, raw_tmpPath;
+	cc_uint8 header[CCR_HEADER_SIZE];
+	struct Stream stream;
+	cc_result res;
+
+	String_InitArray(tmpPath, tmpBuffer);
+	String_Format1(&tmpPath, "%s.tmp", path);
+	Platform_EncodePath(&raw_path,    path);
+	Platform_EncodePath(&raw_tmpPath, &tmpPath);
+
+	res = Stream_CreatePath(&stream, &raw_tmpPath);
+	if (res) { Logger_IOWarn2(res, "creating", &raw_tmpPath); return res; }
+
+	/* Table is rewritten once all the region offsets are known */
+	Mem_Set(header, 0, CCR_HEADER_SIZE);
+	res = Ccr_WriteTable(&stream, header);
+	if (!res) res = Ccr_WriteData(&stream, CCR_HEADER_SIZE + ccr.count * CCR_ENTRY_SIZE, meta, header);
+	if (!res) res = stream.Seek(&stream, 0);
+	if (!res) res = Ccr_WriteTable(&stream, header);
+
+	if (res) {
+		stream.Close(&stream);
+		Logger_IOWarn2(res, "encoding", &raw_tmpPath); return res;
+	}
+
+	res = stream.Close(&stream);
+	if (res) { Logger_IOWarn2(res, "closing", &raw_tmpPath); return res; }
+
+	/* Only replace the existing map file once the new one has been completely written */
+	res = File_Rename(&raw_tmpPath, &raw_path);
+	if (res) { Logger_IOWarn2(res, "replacing", &raw_path); return res; }
+	return 0;
+}
+
+/* Appends changed regions to the end of the existing map file, then updates the header and region table */
+/* NOTE: If writing the header or region table fails, the map file may be left corrupted */
+static cc_result Ccr_WriteChanged(struct Stream* stream, cc_uint32 fileLength, struct Stream* meta) {
+	cc_uint8 header[CCR_HEADER_SIZE];
+	cc_result res;
+
+	if ((res = stream->Seek(stream, fileLength)))                  return res;
+	if ((res = Ccr_WriteData(stream, fileLength, meta, header)))   return res;
+	if ((res = stream->Seek(stream, 0)))                           return res;
+	return Ccr_WriteTable(stream, header);
+}
+
+static cc_result Ccr_Encode(const cc_string* path, struct Stream* meta) {
+	cc_uint32 fileLength, metaLength, unused;
+	struct Stream stream;
+	cc_filepath raw_path;
+	cc_bool existing = false;
+	cc_result res;
+
+	Platform_EncodePath(&raw_path, path);
+	if (File_Exists(&raw_path) && !Stream_AppendPath(&stream, &raw_path)) {
+		existing = !stream.Length(&stream, &fileLength) && !stream.Seek(&stream, 0) 
+						&& Ccr_ReadExisting(&stream, &metaLength);
+		if (!existing) (void)stream.Close(&stream);
+	}
+
+	/* Only compress regions which are different from those in the existing map file */
+	ccr.compressAll = !existing;
+	res = Ccr_ForEachRegion(Ccr_SaveRegion);
+	if (res) goto failed;
+
+	if (existing) {
+		/* Avoid the map file growing endlessly from unused regions */
+		unused  = fileLength - Ccr_LiveLength(metaLength);
+		unused += Ccr_ReplacedLength() + metaLength;
+
+		if (unused <= fileLength / 2) {
+			res = Ccr_WriteChanged(&stream, fileLength, meta);
+			if (res) { stream.Close(&stream); Logger_IOWarn2(res, "encoding", &raw_path); return res; }
+
+			res = stream.Close(&stream);
+			if (res) { Logger_IOWarn2(res, "closing", &raw_path); return res; }
+			return 0;
+		}
+
+		(void)stream.Close(&stream);
+		existing = false;
+		/* Compress all the remaining regions too, since the entire map file is rewritten */
+		ccr.compressAll = true;
+		res = Ccr_ForEachRegion(Ccr_SaveRegion);
+		if (res) goto failed;
+	}
+	return Ccr_WriteAll(path, meta);
+
+failed:
+	if (existing) (void)stream.Close(&stream);
+	Logger_IOWarn2(res, "compressing", &raw_path);
+	return res;
+}
+
+cc_result Ccr_Save(const cc_string* path) {
+	struct Stream meta;
+	cc_bool upper = false;
+	cc_result res;
+	int i;
+#ifdef EXTENDED_BLOCKS
+	upper = World.Blocks != World.Blocks2;
+#endif
+
+	Ccr_InitLayout(World.Width, World.Height, World.Length, CCR_REGION_SHIFT, upper);
+	ccr.table   = (cc_uint8*)Mem_TryAllocCleared(ccr.count, CCR_ENTRY_SIZE);
+	ccr.regions = (struct Stream*)Mem_TryAllocCleared(ccr.count, sizeof(struct Stream));
+	meta.meta.mem.base = NULL;
+
+	if (!ccr.table || !ccr.regions) {
+		res = ERR_OUT_OF_MEMORY;
+		Logger_SysWarn(res, "allocating region map memory");
+	} else if ((res = Ccr_SaveMetadata(&meta))) {
+		Logger_SysWarn(res, "encoding region map metadata");
+	} else {
+		res = Ccr_Encode(path, &meta);
+	}
+
+	for (i = 0; ccr.regions && i < ccr.count; i++) 
+	{
+		Mem_Free(ccr.regions[i].meta.mem.base);
+	}
+	Mem_Free(meta.meta.mem.base);
+	Mem_Free(ccr.regions);
+	Mem_Free(ccr.table);
+
+	ccr.regions = NULL;
+	ccr.table   = NULL;
+	return res;
+}
+
 
 /*########################################################################################################################*
 *---------------------------------------------------Schematic export------------------------------------------------------*
@@ -1869,6 +3036,7 @@ static struct MapImporter lvl_imp   = { ".lvl",     Lvl_Load };
 static struct MapImporter mine_imp  = { ".mine",    Dat_Load };
 static struct MapImporter fcm_imp   = { ".fcm",     Fcm_Load };
 static struct MapImporter mclvl_imp = { ".mclevel", MCLevel_Load };
+static struct MapImporter ccr_imp   = { ".ccr",     Ccr_Load };
 
 static void OnInit(void) {
 	MapImporter_Register(&cw_imp);
@@ -1877,17 +3045,25 @@ static void OnInit(void) {
 	MapImporter_Register(&mine_imp);
 	MapImporter_Register(&fcm_imp);
 	MapImporter_Register(&mclvl_imp);
+	MapImporter_Register(&ccr_imp);
+	CwSave_Init();
 }
 
 static void OnFree(void) {
 	imp_head = NULL;
+	CwSave_Shutdown();
 }
 #else
 /* No point including map format code when can't save/load maps anyways */
 struct MapImporter* MapImporter_Find(const cc_string* path) { return NULL; }
 cc_result Map_LoadFrom(const cc_string* path) { return ERR_NOT_SUPPORTED; }
+cc_result Map_LoadCache(const cc_string* path) { return ERR_NOT_SUPPORTED; }
+cc_result Map_SaveCache(const cc_string* path) { return ERR_NOT_SUPPORTED; }
 
 cc_result Cw_Save(struct Stream* stream)  { return ERR_NOT_SUPPORTED; }
+cc_result Cw_SaveInBackground(const cc_string* path) { return ERR_NOT_SUPPORTED; }
+cc_bool Cw_IsSavingInBackground(void) { return false; }
+cc_result Ccr_Save(const cc_string* path) { return ERR_NOT_SUPPORTED; }
 cc_result Dat_Save(struct Stream* stream) { return ERR_NOT_SUPPORTED; }
 cc_result Schematic_Save(struct Stream* stream) { return ERR_NOT_SUPPORTED; }
 
@@ -28,10 +28,24 @@ CC_API void MapImporter_Register(struct MapImporter* imp);
 CC_API struct MapImporter* MapImporter_Find(const cc_string* path);
 /* Attempts to import a map from the given file */
 CC_API cc_result Map_LoadFrom(const cc_string* path);
+/* Attempts to import a map from the fast load cache of the given map file */
+/* NOTE: Fails if the cache doesn't exist or the map file was changed since the cache was saved */
+cc_result Map_LoadCache(const cc_string* path);
+/* Exports the world to an uncompressed fast load cache for the given map file */
+cc_result Map_SaveCache(const cc_string* path);
 
 /* Exports a world to a .cw ClassicWorld map file. */
 /* Compatible with ClassiCube/ClassicalSharp */
 cc_result Cw_Save(struct Stream* stream);
+/* Begins exporting the world to a .cw ClassicWorld map file on a background thread. */
+/* Progress is reported through WorldEvents.Saving, and the map file is only replaced once fully written. */
+/* NOTE: Returns ERR_NOT_SUPPORTED if background saving isn't supported */
+cc_result Cw_SaveInBackground(const cc_string* path);
+/* Whether the world is currently being exported on a background thread */
+cc_bool Cw_IsSavingInBackground(void);
+/* Exports a world to a .ccr ClassiCube region map file. */
+/* NOTE: If the map file already exists, usually only regions which were changed are written to it */
+cc_result Ccr_Save(const cc_string* path);
 /* Exports a world to a .schematic Schematic map file */
 /* Used by MCEdit and other tools */
 cc_result Schematic_Save(struct Stream* stream);
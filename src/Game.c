@@ -41,6 +41,7 @@
 #include "SystemFonts.h"
 #include "Formats.h"
 #include "EntityRenderers.h"
+#include "BlockPhysics.h"
 
 struct _GameData Game;
 static cc_uint64 frameStart;
@@ -227,6 +228,7 @@ void Game_UpdateBlock(int x, int y, int z, BlockID block) {
 	}
 	Lighting.OnBlockChanged(x, y, z, old, block);
 	MapRenderer_OnBlockChanged(x, y, z, block);
+	Physics_TrackBlock(x, y, z, old, block);
 }
 
 void Game_ChangeBlock(int x, int y, int z, BlockID block) {
@@ -404,6 +406,7 @@ static void Game_Load(void) {
 	Event_Register_(&WindowEvents.Closing,         NULL, Game_PendingClose);
 	Event_Register_(&WindowEvents.InactiveChanged, NULL, HandleInactiveChanged);
 
+	Game_AddComponent(&Utils_Component);
 	Game_AddComponent(&Gfx_Component);
 	Game_AddComponent(&World_Component);
 	Game_AddComponent(&Textures_Component);
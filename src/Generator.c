@@ -1,4 +1,9 @@
 #include "Generator.h"
+/* Included before Funcs.h, as C++ standard headers may undefine min/max */
+#if defined __x86_64__ || defined _M_X64 || defined _M_AMD64
+#include <emmintrin.h>
+#define NOISE_USE_SSE2
+#endif
 #include "BlockID.h"
 #include "ExtMath.h"
 #include "Funcs.h"
@@ -228,15 +233,127 @@ static float OctaveNoise_Calc(const struct OctaveNoise* n, float x, float y) {
 }
 
 
+/* Batched noise functions, which calculate noise for a series of coordinates at once */
+/* NOTE: Results MUST be bit for bit identical to the single value noise functions, */
+/*  otherwise the same seed would generate a different map */
+#define NOISE_BATCH_SIZE 64
+/* NOTE: SSE2 batched noise is only used on x86-64, where regular float math */
+/*  is always performed using SSE2 instructions too. (unlike e.g. 32 bit x86 with x87 math, */
+/*  or ARM where compilers may fuse the multiply and add in the single value noise function) */
+
+#ifdef NOISE_USE_SSE2
+/* x * x * x * (x * (x * 6 - 15) + 10) */
+static CC_INLINE __m128 ImprovedNoise_Fade4(__m128 x) {
+	__m128 t = _mm_sub_ps(_mm_mul_ps(x, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+	t = _mm_add_ps(_mm_mul_ps(x, t), _mm_set1_ps(10.0f));
+	return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(x, x), x), t);
+}
+
+/* Grad(hash, x, y) */
+#define ImprovedNoise_Grad4(gx, gy, x, y) _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gx), x), _mm_mul_ps(_mm_loadu_ps(gy), y))
+
+static int ImprovedNoise_CalcSSE2(const cc_uint8* p, const float* xs, const float* ys, float* out, int count) {
+	float gx22[4], gy22[4], gx12[4], gy12[4];
+	float gx21[4], gy21[4], gx11[4], gy11[4];
+	cc_int32 xFloors[4], yFloors[4];
+	__m128 x, y, u, v, one = _mm_set1_ps(1.0f);
+	__m128 g22, g12, g21, g11, c1, c2;
+	__m128i xFloor, yFloor;
+	int i, j, X, Y, A, B, hash;
+
+	for (i = 0; i + 4 <= count; i += 4)
+	{
+		x = _mm_loadu_ps(xs + i);
+		y = _mm_loadu_ps(ys + i);
+
+		/* xFloor = x >= 0 ? (int)x : (int)x - 1 (comparison mask is -1 when true) */
+		xFloor = _mm_add_epi32(_mm_cvttps_epi32(x), _mm_castps_si128(_mm_cmplt_ps(x, _mm_setzero_ps())));
+		yFloor = _mm_add_epi32(_mm_cvttps_epi32(y), _mm_castps_si128(_mm_cmplt_ps(y, _mm_setzero_ps())));
+		x = _mm_sub_ps(x, _mm_cvtepi32_ps(xFloor));
+		y = _mm_sub_ps(y, _mm_cvtepi32_ps(yFloor));
+
+		u = ImprovedNoise_Fade4(x);
+		v = ImprovedNoise_Fade4(y);
+
+		/* SSE2 lacks a gather instruction, so permutation table lookups are done per lane */
+		_mm_storeu_si128((__m128i*)xFloors, xFloor);
+		_mm_storeu_si128((__m128i*)yFloors, yFloor);
+
+		for (j = 0; j < 4; j++)
+		{
+			X = xFloors[j] & 0xFF; Y = yFloors[j] & 0xFF;
+			A = p[X] + Y; B = p[X + 1] + Y;
+
+			hash = (p[p[A]] & 0xF) << 1;
+			gx22[j] = (float)(((X_FLAGS >> hash) & 3) - 1); gy22[j] = (float)(((Y_FLAGS >> hash) & 3) - 1);
+			hash = (p[p[B]] & 0xF) << 1;
+			gx12[j] = (float)(((X_FLAGS >> hash) & 3) - 1); gy12[j] = (float)(((Y_FLAGS >> hash) & 3) - 1);
+			hash = (p[p[A + 1]] & 0xF) << 1;
+			gx21[j] = (float)(((X_FLAGS >> hash) & 3) - 1); gy21[j] = (float)(((Y_FLAGS >> hash) & 3) - 1);
+			hash = (p[p[B + 1]] & 0xF) << 1;
+			gx11[j] = (float)(((X_FLAGS >> hash) & 3) - 1); gy11[j] = (float)(((Y_FLAGS >> hash) & 3) - 1);
+		}
+
+		g22 = ImprovedNoise_Grad4(gx22, gy22, x,                   y);
+		g12 = ImprovedNoise_Grad4(gx12, gy12, _mm_sub_ps(x, one), y);
+		c1  = _mm_add_ps(g22, _mm_mul_ps(u, _mm_sub_ps(g12, g22)));
+
+		g21 = ImprovedNoise_Grad4(gx21, gy21, x,                   _mm_sub_ps(y, one));
+		g11 = ImprovedNoise_Grad4(gx11, gy11, _mm_sub_ps(x, one), _mm_sub_ps(y, one));
+		c2  = _mm_add_ps(g21, _mm_mul_ps(u, _mm_sub_ps(g11, g21)));
+
+		_mm_storeu_ps(out + i, _mm_add_ps(c1, _mm_mul_ps(v, _mm_sub_ps(c2, c1))));
+	}
+	return i;
+}
+#endif
+
+static void ImprovedNoise_CalcBatch(const cc_uint8* p, const float* xs, const float* ys, float* out, int count) {
+	int i = 0;
+#ifdef NOISE_USE_SSE2
+	i = ImprovedNoise_CalcSSE2(p, xs, ys, out, count);
+#endif
+	for (; i < count; i++) 
+	{
+		out[i] = ImprovedNoise_Calc(p, xs[i], ys[i]);
+	}
+}
+
+static void OctaveNoise_CalcBatch(const struct OctaveNoise* n, const float* xs, const float* ys, float* sums, int count) {
+	float amplitude = 1, freq = 1;
+	float octX[NOISE_BATCH_SIZE], octY[NOISE_BATCH_SIZE], value[NOISE_BATCH_SIZE];
+	int i, j;
+
+	for (j = 0; j < count; j++) { sums[j] = 0; }
+
+	for (i = 0; i < n->octaves; i++) {
+		for (j = 0; j < count; j++) 
+		{
+			octX[j] = xs[j] * freq;
+			octY[j] = ys[j] * freq;
+		}
+		ImprovedNoise_CalcBatch(n->p[i], octX, octY, value, count);
+
+		for (j = 0; j < count; j++) { sums[j] += value[j] * amplitude; }
+		amplitude *= 2.0f;
+		freq *= 0.5f;
+	}
+}
+
+
 struct CombinedNoise { struct OctaveNoise noise1, noise2; };
 static void CombinedNoise_Init(struct CombinedNoise* n, RNGState* rnd, int octaves1, int octaves2) {
 	OctaveNoise_Init(&n->noise1, rnd, octaves1);
 	OctaveNoise_Init(&n->noise2, rnd, octaves2);
 }
 
-static float CombinedNoise_Calc(const struct CombinedNoise* n, float x, float y) {
-	float offset = OctaveNoise_Calc(&n->noise2, x, y);
-	return OctaveNoise_Calc(&n->noise1, x + offset, y);
+static void CombinedNoise_CalcBatch(const struct CombinedNoise* n, const float* xs, const float* ys, float* out, int count) {
+	float offsetX[NOISE_BATCH_SIZE];
+	int i;
+	OctaveNoise_CalcBatch(&n->noise2, xs, ys, offsetX, count);
+
+	for (i = 0; i < count; i++) { offsetX[i] += xs[i]; }
+	OctaveNoise_CalcBatch(&n->noise1, offsetX, ys, out, count);
 }
 
 
@@ -314,10 +431,62 @@ static void NotchyGen_FloodFill(int index, BlockRaw block) {
 }
 
 
-static void NotchyGen_CreateHeightmap(void) {
+/* The noise heavy steps are independent for each column of the map, */
+/*  so are split into rows which are then processed across multiple threads */
+/* NOTE: Noise must still be initialised in the same order, to keep output identical for a given seed */
+static const struct CombinedNoise* gen_combined1;
+static const struct CombinedNoise* gen_combined2;
+static const struct OctaveNoise* gen_octave1;
+static const struct OctaveNoise* gen_octave2;
+static int gen_minStoneY;
+
+static void NotchyGen_HeightmapRow(int z) {
+	float xs[NOISE_BATCH_SIZE], zs[NOISE_BATCH_SIZE];
+	float scaledXs[NOISE_BATCH_SIZE], scaledZs[NOISE_BATCH_SIZE];
+	float highXs[NOISE_BATCH_SIZE], highZs[NOISE_BATCH_SIZE];
+	float hLows[NOISE_BATCH_SIZE], hHighs[NOISE_BATCH_SIZE], selectors[NOISE_BATCH_SIZE];
 	float hLow, hHigh, height;
-	int hIndex = 0, adjHeight;
-	int x, z;
+	int hIndex = z * World.Width;
+	int x, i, j, count;
+
+	for (x = 0; x < World.Width; x += count) {
+		count = min(World.Width - x, NOISE_BATCH_SIZE);
+		for (i = 0; i < count; i++) 
+		{
+			xs[i] = (float)(x + i);      zs[i] = (float)z;
+			scaledXs[i] = (x + i) * 1.3f; scaledZs[i] = z * 1.3f;
+		}
+
+		CombinedNoise_CalcBatch(gen_combined1, scaledXs, scaledZs, hLows,     count);
+		OctaveNoise_CalcBatch(gen_octave1,     xs,       zs,       selectors, count);
+
+		/* High noise is only needed for columns where the selector is <= 0 */
+		for (i = 0, j = 0; i < count; i++) 
+		{
+			if (selectors[i] > 0) continue;
+			highXs[j] = scaledXs[i]; highZs[j] = scaledZs[i]; j++;
+		}
+		CombinedNoise_CalcBatch(gen_combined2, highXs, highZs, hHighs, j);
+
+		for (i = 0, j = 0; i < count; i++) 
+		{
+			hLow   = hLows[i] / 6 - 4;
+			height = hLow;
+
+			if (selectors[i] <= 0) {
+				hHigh  = hHighs[j++] / 5 + 6;
+				height = max(hLow, hHigh);
+			}
+
+			height *= 0.5f;
+			if (height < 0) height *= 0.8f;
+			heightmap[hIndex++] = (int)(height + waterLevel);
+		}
+	}
+}
+
+static void NotchyGen_CreateHeightmap(void) {
+	int i, count = World.Width * World.Length;
 
 #if CC_BUILD_MAXSTACK <= (16 * 1024)
 	struct NoiseBuffer { 
@@ -340,26 +509,15 @@ static void NotchyGen_CreateHeightmap(void) {
 	CombinedNoise_Init(n2, &rnd, 8, 8);	
 	OctaveNoise_Init(n3,   &rnd, 6);
 
-	Gen_CurrentState = "Building heightmap";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
-
-		for (x = 0; x < World.Width; x++) {
-			hLow   = CombinedNoise_Calc(n1, x * 1.3f, z * 1.3f) / 6 - 4;
-			height = hLow;
+	gen_combined1 = n1;
+	gen_combined2 = n2;
+	gen_octave1   = n3;
 
-			if (OctaveNoise_Calc(n3, (float)x, (float)z) <= 0) {
-				hHigh = CombinedNoise_Calc(n2, x * 1.3f, z * 1.3f) / 5 + 6;
-				height = max(hLow, hHigh);
-			}
-
-			height *= 0.5f;
-			if (height < 0) height *= 0.8f;
+	Gen_CurrentState = "Building heightmap";
+	Utils_ParallelFor(World.Length, NotchyGen_HeightmapRow, &Gen_CurrentProgress);
 
-			adjHeight = (int)(height + waterLevel);
-			minHeight = min(adjHeight, minHeight);
-			heightmap[hIndex++] = adjHeight;
-		}
+	for (i = 0; i < count; i++) {
+		minHeight = min(heightmap[i], minHeight);
 	}
 }
 
@@ -392,43 +550,56 @@ static int NotchyGen_CreateStrataFast(void) {
 	return max(stoneHeight, 1);
 }
 
-static void NotchyGen_CreateStrata(void) {
+static void NotchyGen_StrataRow(int z) {
+	float xs[NOISE_BATCH_SIZE], zs[NOISE_BATCH_SIZE], thickness[NOISE_BATCH_SIZE];
 	int dirtThickness, dirtHeight;
-	int minStoneY, stoneHeight;
-	int hIndex = 0, maxY = World.MaxY, index = 0;
-	int x, y, z;
-	struct OctaveNoise n;
+	int minStoneY = gen_minStoneY, stoneHeight;
+	int hIndex = z * World.Width, maxY = World.MaxY, index;
+	int x, y, i, count;
 
-	/* Try to bulk fill bottom of the map if possible */
-	minStoneY = NotchyGen_CreateStrataFast();
-	OctaveNoise_Init(&n, &rnd, 8);
-
-	Gen_CurrentState = "Creating strata";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
+	for (x = 0; x < World.Width; x++) {
+		i = x % NOISE_BATCH_SIZE;
+		/* Calculate noise for the next series of columns */
+		if (!i) {
+			count = min(World.Width - x, NOISE_BATCH_SIZE);
+			for (i = 0; i < count; i++) { xs[i] = (float)(x + i); zs[i] = (float)z; }
+
+			OctaveNoise_CalcBatch(gen_octave1, xs, zs, thickness, count);
+			i = 0;
+		}
 
-		for (x = 0; x < World.Width; x++) {
-			dirtThickness = (int)(OctaveNoise_Calc(&n, (float)x, (float)z) / 24 - 4);
-			dirtHeight    = heightmap[hIndex++];
-			stoneHeight   = dirtHeight + dirtThickness;
+		dirtThickness = (int)(thickness[i] / 24 - 4);
+		dirtHeight    = heightmap[hIndex++];
+		stoneHeight   = dirtHeight + dirtThickness;
 
-			stoneHeight = min(stoneHeight, maxY);
-			dirtHeight  = min(dirtHeight,  maxY);
+		stoneHeight = min(stoneHeight, maxY);
+		dirtHeight  = min(dirtHeight,  maxY);
 
-			index = World_Pack(x, minStoneY, z);
-			for (y = minStoneY; y <= stoneHeight; y++) {
-				Gen_Blocks[index] = BLOCK_STONE; index += World.OneY;
-			}
+		index = World_Pack(x, minStoneY, z);
+		for (y = minStoneY; y <= stoneHeight; y++) {
+			Gen_Blocks[index] = BLOCK_STONE; index += World.OneY;
+		}
 
-			stoneHeight = max(stoneHeight, 0);
-			index = World_Pack(x, (stoneHeight + 1), z);
-			for (y = stoneHeight + 1; y <= dirtHeight; y++) {
-				Gen_Blocks[index] = BLOCK_DIRT; index += World.OneY;
-			}
+		stoneHeight = max(stoneHeight, 0);
+		index = World_Pack(x, (stoneHeight + 1), z);
+		for (y = stoneHeight + 1; y <= dirtHeight; y++) {
+			Gen_Blocks[index] = BLOCK_DIRT; index += World.OneY;
 		}
 	}
 }
 
+static void NotchyGen_CreateStrata(void) {
+	struct OctaveNoise n;
+
+	/* Try to bulk fill bottom of the map if possible */
+	gen_minStoneY = NotchyGen_CreateStrataFast();
+	OctaveNoise_Init(&n, &rnd, 8);
+	gen_octave1 = &n;
+
+	Gen_CurrentState = "Creating strata";
+	Utils_ParallelFor(World.Length, NotchyGen_StrataRow, &Gen_CurrentProgress);
+}
+
 static void NotchyGen_CarveCaves(void) {
 	int cavesCount, caveLen;
 	float caveX, caveY, caveZ;
@@ -569,10 +740,28 @@ static void NotchyGen_FloodFillLava(void) {
 	}
 }
 
-static void NotchyGen_CreateSurfaceLayer(void) {	
-	int hIndex = 0, index;
+static void NotchyGen_SurfaceRow(int z) {
+	int hIndex = z * World.Width, index;
 	BlockRaw above;
-	int x, y, z;
+	int x, y;
+
+	for (x = 0; x < World.Width; x++) {
+		y = heightmap[hIndex++];
+		if (y < 0 || y >= World.Height) continue;
+
+		index = World_Pack(x, y, z);
+		above = y >= World.MaxY ? BLOCK_AIR : Gen_Blocks[index + World.OneY];
+
+		/* TODO: update heightmap */
+		if (above == BLOCK_STILL_WATER && (OctaveNoise_Calc(gen_octave2, (float)x, (float)z) > 12)) {
+			Gen_Blocks[index] = BLOCK_GRAVEL;
+		} else if (above == BLOCK_AIR) {
+			Gen_Blocks[index] = (y <= waterLevel && (OctaveNoise_Calc(gen_octave1, (float)x, (float)z) > 8)) ? BLOCK_SAND : BLOCK_GRASS;
+		}
+	}
+}
+
+static void NotchyGen_CreateSurfaceLayer(void) {	
 #if CC_BUILD_MAXSTACK <= (16 * 1024)
 	struct NoiseBuffer { 
 		struct OctaveNoise n1, n2;
@@ -588,26 +777,11 @@ static void NotchyGen_CreateSurfaceLayer(void) {
 
 	OctaveNoise_Init(n1, &rnd, 8);
 	OctaveNoise_Init(n2, &rnd, 8);
+	gen_octave1 = n1;
+	gen_octave2 = n2;
 
 	Gen_CurrentState = "Creating surface";
-	for (z = 0; z < World.Length; z++) {
-		Gen_CurrentProgress = (float)z / World.Length;
-
-		for (x = 0; x < World.Width; x++) {
-			y = heightmap[hIndex++];
-			if (y < 0 || y >= World.Height) continue;
-
-			index = World_Pack(x, y, z);
-			above = y >= World.MaxY ? BLOCK_AIR : Gen_Blocks[index + World.OneY];
-
-			/* TODO: update heightmap */
-			if (above == BLOCK_STILL_WATER && (OctaveNoise_Calc(n2, (float)x, (float)z) > 12)) {
-				Gen_Blocks[index] = BLOCK_GRAVEL;
-			} else if (above == BLOCK_AIR) {
-				Gen_Blocks[index] = (y <= waterLevel && (OctaveNoise_Calc(n1, (float)x, (float)z) > 8)) ? BLOCK_SAND : BLOCK_GRASS;
-			}
-		}
-	}
+	Utils_ParallelFor(World.Length, NotchyGen_SurfaceRow, &Gen_CurrentProgress);
 }
 
 static void NotchyGen_PlantFlowers(void) {
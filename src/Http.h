@@ -14,8 +14,14 @@ struct ScheduledTask;
 struct StringsBuffer;
 
 #define URL_MAX_SIZE (STRING_SIZE * 2)
-#define HTTP_FLAG_PRIORITY 0x01
-#define HTTP_FLAG_NOCACHE  0x02
+/* Request is processed before all normal and background requests (e.g. texture packs) */
+#define HTTP_FLAG_PRIORITY   0x01
+#define HTTP_FLAG_NOCACHE    0x02
+/* Request is processed after all normal requests (e.g. server list flags) */
+#define HTTP_FLAG_BACKGROUND 0x04
+/* Response is stored in the on-disk cache, and only downloaded again if it has since changed */
+/* NOTE: Ignored when lastModified/etag/cookies are provided, or when the request isn't a GET request */
+#define HTTP_FLAG_DISKCACHE  0x08
 
 extern struct IGameComponent Http_Component;
 
@@ -42,8 +48,11 @@ struct HttpRequest {
 	char lastModified[STRING_SIZE]; /* Time item cached at (if at all) */
 	char etag[STRING_SIZE];         /* ETag of cached item (if any) */
 	cc_uint8 requestType;           /* See the various REQUEST_TYPE_ */
+	cc_uint8 priority;              /* (private) Order in which pending requests are processed */
+	cc_bool diskCache;              /* (private) Whether response is stored in the on-disk cache */
 	cc_bool success;                /* Whether Result is 0, status is 200, and data is not NULL */
 	struct StringsBuffer* cookies;  /* Cookie list sent in requests. May be modified by the response. */
+	                                /* NOTE: Must not be accessed while requests using it are in progress */
 };
 
 /* Frees all dynamically allocated data from a HTTP request */
@@ -63,7 +72,7 @@ int Http_AsyncPostData(const cc_string* url, cc_uint8 flags, const void* data, c
 /* Also sets the If-Modified-Since and If-None-Match headers. (if not NULL)  */
 int Http_AsyncGetDataEx(const cc_string* url, cc_uint8 flags, const cc_string* lastModified, const cc_string* etag, struct StringsBuffer* cookies);
 /* Attempts to remove given request from pending and finished request lists. */
-/* NOTE: Won't cancel the request if it is currently in progress. */
+/* NOTE: If the request is currently in progress, its result is discarded once finished. */
 void Http_TryCancel(int reqID);
 
 /* Encodes data using % or URL encoding. */
@@ -77,7 +86,8 @@ cc_bool Http_DescribeError(cc_result res, cc_string* dst);
 /* NOTE: You MUST check Success for whether it completed successfully. */
 /* (Data may still be non NULL even on error, e.g. on a http 404 error) */
 cc_bool Http_GetResult(int reqID, struct HttpRequest* item);
-/* Retrieves information about the request currently being processed. */
+/* Retrieves information about a request currently being processed. */
+/* NOTE: When multiple requests are being processed, only the first is returned */
 cc_bool Http_GetCurrent(int* reqID, int* progress);
 /* Retrieves information about the download progress of the given request. */
 /* NOTE: This may return HTTP_PROGRESS_NOT_WORKING_ON if download has finished. */
@@ -49,10 +49,10 @@ struct IGameComponent Http_Component = {
 };
 #else
 #include "_HttpBase.h"
-
-#if CC_NET_BACKEND == CC_NET_BACKEND_BUILTIN
 #include "Errors.h"
 #include "PackedCol.h"
+
+#if CC_NET_BACKEND == CC_NET_BACKEND_BUILTIN
 #include "SSL.h"
 
 /*########################################################################################################################*
@@ -271,11 +271,20 @@ static cc_result HttpConnection_WriteAll(struct HttpConnection* conn, const cc_u
 /*########################################################################################################################*
 *-----------------------------------------------------Connection Pool-----------------------------------------------------*
 *#########################################################################################################################*/
+static void* poolMutex;
+/* Number of requests which opened a new connection, and which reused an existing connection */
+static int pool_numOpened, pool_numReused;
+/* Connections idle for longer than this have likely been closed by the server */
+#define POOL_IDLE_TIMEOUT_MS (15 * 1000)
+
+/* NOTE: Must have more entries than HTTP_MAX_WORKERS, so there is always an unused entry */
 static struct ConnectionPoolEntry {
 	struct HttpConnection conn;
 	cc_string addr;
 	char addrBuffer[STRING_SIZE];
 	cc_bool https;
+	cc_bool inUse;      /* Whether a worker is currently using this connection */
+	cc_uint64 lastUsed; /* Time connection was last released by a worker */
 } connection_pool[10];
 
 static cc_result ConnectionPool_Insert(int i, struct HttpConnection** conn, const struct HttpUrl* url) {
@@ -288,31 +297,107 @@ static cc_result ConnectionPool_Insert(int i, struct HttpConnection** conn, cons
 	return HttpConnection_Open(&e->conn, url);
 }
 
-static cc_result ConnectionPool_Open(struct HttpConnection** conn, const struct HttpUrl* url) {
-	struct ConnectionPoolEntry* e;
+static struct ConnectionPoolEntry* ConnectionPool_Get(struct HttpConnection* conn) {
 	int i;
+	for (i = 0; i < Array_Elems(connection_pool); i++)
+	{
+		if (&connection_pool[i].conn == conn) return &connection_pool[i];
+	}
+	return NULL;
+}
 
+/* Whether the given connection is still open and to the same server as the given URL */
+static cc_bool ConnectionPool_Matches(struct HttpConnection* conn, const struct HttpUrl* url) {
+	struct ConnectionPoolEntry* e = ConnectionPool_Get(conn);
+	return conn->valid && e->https == url->https && String_Equals(&e->addr, &url->address);
+}
+
+/* Finds an unused open connection to the given address, or otherwise an unused entry to open a new connection in */
+/* Connections idle for too long are moved into stale, so they can be closed after poolMutex is released */
+/* NOTE: Must be called while holding poolMutex */
+static int ConnectionPool_Find(const struct HttpUrl* url, cc_bool* reuse, struct HttpConnection* stale, int* numStale) {
+	struct ConnectionPoolEntry* e;
+	cc_uint64 now = Stopwatch_Measure();
+	int i, lru = -1;
+
+	*reuse = true;
 	for (i = 0; i < Array_Elems(connection_pool); i++)
 	{
 		e = &connection_pool[i];
-		if (e->conn.valid && e->https == url->https && String_Equals(&e->addr, &url->address)) {
-			*conn = &connection_pool[i].conn;
-			return 0;
+		if (e->inUse || !e->conn.valid) continue;
+
+		if (Stopwatch_ElapsedMS(e->lastUsed, now) >= POOL_IDLE_TIMEOUT_MS) {
+			stale[(*numStale)++] = e->conn;
+			e->conn.socket = -1;
+			e->conn.sslCtx = NULL;
+			e->conn.valid  = false;
+			continue;
 		}
+		if (ConnectionPool_Matches(&e->conn, url)) return i;
 	}
 
+	*reuse = false;
 	for (i = 0; i < Array_Elems(connection_pool); i++)
 	{
 		e = &connection_pool[i];
-		if (!e->conn.valid) return ConnectionPool_Insert(i, conn, url);
+		if (!e->inUse && !e->conn.valid) return i;
 	}
 
-	/* TODO: Should we be consistent in which entry gets evicted? */
-	i = (cc_uint8)Stopwatch_Measure() % Array_Elems(connection_pool);
-	HttpConnection_Close(&connection_pool[i].conn);
+	/* Evict the least recently used connection */
+	for (i = 0; i < Array_Elems(connection_pool); i++)
+	{
+		e = &connection_pool[i];
+		if (e->inUse) continue;
+		if (lru == -1 || e->lastUsed < connection_pool[lru].lastUsed) lru = i;
+	}
+	return lru;
+}
+
+static cc_result ConnectionPool_Open(struct HttpConnection** conn, const struct HttpUrl* url) {
+	struct HttpConnection stale[Array_Elems(connection_pool)];
+	int i, j, numStale = 0;
+	cc_bool reuse;
+
+	Mutex_Lock(poolMutex);
+	{
+		i = ConnectionPool_Find(url, &reuse, stale, &numStale);
+		connection_pool[i].inUse = true;
+
+		if (reuse) { pool_numReused++; } else { pool_numOpened++; }
+	}
+	Mutex_Unlock(poolMutex);
+
+	/* Closing SSL connections can be slow, so avoid blocking other workers */
+	for (j = 0; j < numStale; j++) HttpConnection_Close(&stale[j]);
+
+	*conn = &connection_pool[i].conn;
+	if (reuse) return 0;
+
+	/* Entry is owned by this worker now, so can be closed without holding the lock */
+	if (connection_pool[i].conn.valid) HttpConnection_Close(*conn);
 	return ConnectionPool_Insert(i, conn, url);
 }
 
+static void ConnectionPool_LogStats(void) {
+	Mutex_Lock(poolMutex);
+	{
+		Platform_Log2("HTTP connections: %i opened, %i reused", &pool_numOpened, &pool_numReused);
+	}
+	Mutex_Unlock(poolMutex);
+}
+
+/* Allows other workers to use the given connection again */
+static void ConnectionPool_Release(struct HttpConnection* conn) {
+	struct ConnectionPoolEntry* e = ConnectionPool_Get(conn);
+
+	Mutex_Lock(poolMutex);
+	{
+		e->inUse    = false;
+		e->lastUsed = Stopwatch_Measure();
+	}
+	Mutex_Unlock(poolMutex);
+}
+
 
 /*########################################################################################################################*
 *--------------------------------------------------------HttpClient-------------------------------------------------------*
@@ -344,6 +429,7 @@ struct HttpClientState {
 	struct HttpConnection* conn;
 	struct HttpRequest* req;
 	cc_uint32 dataLeft; /* Number of bytes still to read from the current chunk or body */
+	cc_uint32 unread;   /* Number of bytes read past the end of the response (e.g. pipelined responses) */
 	cc_bool chunked;    /* Whether content is being transferred using HTTP chunks */
 	cc_bool autoClose;  /* TODO Whether connection should be dropped after request completed */
 	cc_bool retried;    /* Whether request has been retried due to SSL context being closed/dropped */
@@ -359,6 +445,7 @@ static void HttpClientState_Reset(struct HttpClientState* state) {
 	state->state     = HTTP_RESPONSE_STATE_INITIAL;
 	state->chunked   = false;
 	state->dataLeft  = 0;
+	state->unread    = 0;
 	state->autoClose = false;
 
 	String_InitArray(state->header,   state->_headerBuffer);
@@ -368,6 +455,7 @@ static void HttpClientState_Reset(struct HttpClientState* state) {
 static void HttpClientState_Init(struct HttpClientState* state, struct HttpRequest* req) {
 	cc_string url    = String_FromRawArray(req->url);
 	state->req       = req;
+	state->conn      = NULL;
 	state->retried   = false;
 	state->redirects = 0;
 
@@ -466,6 +554,7 @@ static cc_result HttpClient_Process(struct HttpClientState* state, char* buffer,
 	struct HttpRequest* req = state->req;
 	cc_uint32 left, avail, read;
 	int offset = 0, chunkLen, ok;
+	state->unread = 0;
 
 	while (offset < total) {
 		switch (state->state) {
@@ -590,24 +679,32 @@ static cc_result HttpClient_Process(struct HttpClientState* state, char* buffer,
 		break;
 
 		default:
+			state->unread = total - offset;
 			return 0;
 		}
 	}
 	return 0;
 }
 
-static cc_result HttpClient_ParseResponse(struct HttpClientState* state) {
+/* Reads the response to a request, with 'unread' bytes of the response already read into the start of buffer */
+/* NOTE: Bytes read past the end of the response are moved to the start of buffer, and 'unread' set to their count */
+static cc_result HttpClient_ReadResponse(struct HttpClientState* state, cc_uint8* buffer, cc_uint32* unread) {
 	struct HttpRequest* req = state->req;
-	cc_uint8 buffer[INPUT_BUFFER_LEN];
 	cc_uint8* dst;
 	cc_uint32 total;
 	cc_result res;
 
 	for (;;) 
 	{
-		dst = state->dataLeft > INPUT_BUFFER_LEN ? (req->data + req->size) : buffer;
-		res = HttpConnection_Read(state->conn, dst, INPUT_BUFFER_LEN, &total);
-		if (res) return res;
+		if (*unread) {
+			dst   = buffer;
+			total = *unread;
+			*unread = 0;
+		} else {
+			dst = state->dataLeft > INPUT_BUFFER_LEN ? (req->data + req->size) : buffer;
+			res = HttpConnection_Read(state->conn, dst, INPUT_BUFFER_LEN, &total);
+			if (res) return res;
+		}
 
 		if (total == 0) {
 			Platform_Log1("Http read unexpectedly returned 0 in state %i", &state->state);
@@ -625,10 +722,20 @@ static cc_result HttpClient_ParseResponse(struct HttpClientState* state) {
 		}
 
 		if (res) return res;
-		if (state->state == HTTP_RESPONSE_STATE_DONE) return 0;
+		if (state->state != HTTP_RESPONSE_STATE_DONE) continue;
+
+		*unread = state->unread;
+		Mem_Move(buffer, buffer + total - state->unread, state->unread);
+		return 0;
 	}
 }
 
+static cc_result HttpClient_ParseResponse(struct HttpClientState* state) {
+	cc_uint8 buffer[INPUT_BUFFER_LEN];
+	cc_uint32 unread = 0;
+	return HttpClient_ReadResponse(state, buffer, &unread);
+}
+
 static cc_bool HttpClient_IsRedirect(struct HttpRequest* req) {
 	return req->statusCode >= 300 && req->statusCode <= 399 && req->statusCode != 304;
 }
@@ -651,24 +758,30 @@ static void HttpBackend_Init(void) {
 	SSLBackend_Init(httpsVerify);
 }
 
+static void HttpBackend_ReleaseConnection(struct HttpClientState* state) {
+	if (!state->conn) return;
+
+	ConnectionPool_Release(state->conn);
+	state->conn = NULL;
+}
+
 static cc_result HttpBackend_PerformRequest(struct HttpClientState* state) {
 	char buf[SEND_BUFFER_LEN];
 	cc_string inputMsg;
-	cc_result res;
+	cc_result res = 0;
 
 	String_InitArray(inputMsg, buf);
 	HttpClient_Serialise(state, &inputMsg);
 
-	res = ConnectionPool_Open(&state->conn, &state->url);
-	if (res) { HttpConnection_Close(state->conn); return res; }
-
-	state->req->progress = HTTP_PROGRESS_FETCHING_DATA;
-	res = HttpConnection_WriteAll(state->conn, (cc_uint8*)buf, inputMsg.length);
-	if (res) { HttpConnection_Close(state->conn); return res; }
-
-	res = HttpClient_ParseResponse(state);
-	if (res) HttpConnection_Close(state->conn);
+	if (!state->conn) res = ConnectionPool_Open(&state->conn, &state->url);
+	if (!res) {
+		state->req->progress = HTTP_PROGRESS_FETCHING_DATA;
+		res = HttpConnection_WriteAll(state->conn, (cc_uint8*)buf, inputMsg.length);
+	}
+	if (!res) res = HttpClient_ParseResponse(state);
 
+	if (res || state->autoClose) HttpConnection_Close(state->conn);
+	if (res) HttpBackend_ReleaseConnection(state);
 	return res;
 }
 static const char* verbs[] = { "GET", "HEAD", "POST" };
@@ -701,31 +814,130 @@ static cc_result HttpBackend_Do(struct HttpRequest* req) {
 		}
 
 		if (res || !HttpClient_IsRedirect(req)) break;
-		if (state.redirects >= 20) return HTTP_ERR_REDIRECTS;
+		if (state.redirects >= 20) { res = HTTP_ERR_REDIRECTS; break; }
 
 		/* TODO FOLLOW LOCATION PROPERLY */
 		state.redirects++;
 		res = HttpClient_HandleRedirect(&state);
 		if (res) break;
+
+		/* Keep using the same connection when redirected to the same server */
+		if (!ConnectionPool_Matches(state.conn, &state.url)) HttpBackend_ReleaseConnection(&state);
 		HttpClientState_Reset(&state);
 	}
+
+	HttpBackend_ReleaseConnection(&state);
 	return res;
 }
 
+/* Adds the request message for the given request, if there is enough room left for it */
+static cc_bool HttpBackend_SerialisePipelined(struct HttpClientState* state, cc_string* msg) {
+	int length = msg->length;
+	HttpClient_Serialise(state, msg);
+	/* Request message may have been truncated */
+	if (msg->length < msg->capacity) return true;
+
+	msg->length = length;
+	return false;
+}
+
+/* Sends multiple requests to the same server at once, then reads all the responses in order */
+/* Returns the number of requests whose responses were received */
+/* NOTE: Requests must not have any data or cookies, and must all be to the same server */
+static int HttpBackend_DoPipelined(struct HttpRequest* reqs, int count) {
+	struct HttpClientState state;
+	struct HttpConnection* conn = NULL;
+	struct HttpRequest backup;
+	cc_uint8 buffer[INPUT_BUFFER_LEN];
+	char sendBuffer[SEND_BUFFER_LEN];
+	cc_uint32 unread = 0;
+	cc_string msg;
+	cc_result res;
+	int i, sent;
+
+	String_InitArray(msg, sendBuffer);
+	for (sent = 0; sent < count; sent++)
+	{
+		HttpClientState_Init(&state, &reqs[sent]);
+		if (!HttpBackend_SerialisePipelined(&state, &msg)) break;
+	}
+	if (!sent) return 0;
+
+	Platform_Log3("Fetching %c%s (%i pipelined requests)", state.url.https ? "https://" : "http://", 
+				&state.url.address, &sent);
+	res = ConnectionPool_Open(&conn, &state.url);
+	if (!res) res = HttpConnection_WriteAll(conn, (cc_uint8*)sendBuffer, msg.length);
+
+	for (i = 0; !res && i < sent; i++)
+	{
+		HttpClientState_Init(&state, &reqs[i]);
+		state.conn = conn;
+		reqs[i].progress = HTTP_PROGRESS_FETCHING_DATA;
+
+		/* Partially received request is performed normally again instead */
+		HttpRequest_Copy(&backup, &reqs[i]);
+		res = HttpClient_ReadResponse(&state, buffer, &unread);
+		if (res) {
+			HttpRequest_Free(&reqs[i]);
+			HttpRequest_Copy(&reqs[i], &backup);
+			break;
+		}
+
+		/* Redirects are followed by performing the request normally again */
+		if (HttpClient_IsRedirect(&reqs[i])) {
+			HttpRequest_Free(&reqs[i]);
+			HttpRequest_Copy(&reqs[i], &backup);
+			break;
+		}
+		/* Server won't send responses to any of the other requests */
+		if (state.autoClose) { i++; break; }
+	}
+
+	/* Responses still to be sent by the server can't be ignored */
+	if (conn && (res || i < sent || state.autoClose)) HttpConnection_Close(conn);
+	if (conn) ConnectionPool_Release(conn);
+	return i;
+}
+
 static cc_bool HttpBackend_DescribeError(cc_result res, cc_string* dst) {
 	return SSLBackend_DescribeError(res, dst);
 }
 #endif
 
 
+#if CC_BUILD_MAXSTACK <= (48 * 1024)
+	#define HTTP_DEF_WORKERS 2
+#else
+	#define HTTP_DEF_WORKERS 4
+#endif
+#define HTTP_MAX_WORKERS 8
+/* Maximum number of workers that can process requests to the same server at once */
+/* NOTE: Less than default number of workers, so e.g. lots of skin downloads can't delay a texture pack */
+#define HTTP_MAX_ORIGIN_WORKERS 3
+/* Maximum number of requests a worker sends at once when pipelining */
+#define HTTP_MAX_PIPELINE 4
+
+struct HttpWorker {
+	void* thread;
+	struct HttpRequest requests[HTTP_MAX_PIPELINE]; /* Requests currently being processed (id is 0 when finished) */
+	cc_bool cancelled[HTTP_MAX_PIPELINE];           /* Whether request was cancelled while being processed */
+	int numRequests;
+	cc_string origin; /* Scheme and address of server requests are being sent to */
+	char _originBuffer[STRING_SIZE + 16];
+};
+
 static void* workerWaitable;
-static void* workerThread;
+static struct HttpWorker http_workers[HTTP_MAX_WORKERS];
+static int http_numWorkers, http_startedWorkers;
+static cc_bool http_pipelining;
 
 static void* pendingMutex;
 static struct RequestList pendingReqs;
 
+/* Protects the current requests of all workers */
 static void* curRequestMutex;
-static struct HttpRequest http_curRequest;
+/* Cookie lists aren't thread safe, so requests with cookies are performed one at a time */
+static void* cookiesMutex;
 
 
 /*########################################################################################################################*
@@ -743,21 +955,61 @@ cc_bool Http_GetResult(int reqID, struct HttpRequest* item) {
 	return i >= 0;
 }
 
+/* Finds the request with the given id that a worker is currently processing */
+/* NOTE: Must be called while holding curRequestMutex */
+static struct HttpRequest* HttpWorker_FindRequest(int reqID, cc_bool** cancelled) {
+	struct HttpWorker* worker;
+	int i, j;
+
+	for (i = 0; i < HTTP_MAX_WORKERS; i++)
+	{
+		worker = &http_workers[i];
+		for (j = 0; j < HTTP_MAX_PIPELINE; j++)
+		{
+			if (worker->requests[j].id != reqID) continue;
+
+			*cancelled = &worker->cancelled[j];
+			return &worker->requests[j];
+		}
+	}
+	return NULL;
+}
+
 cc_bool Http_GetCurrent(int* reqID, int* progress) {
+	int i, j;
+	*reqID    = 0;
+	*progress = HTTP_PROGRESS_NOT_WORKING_ON;
+
 	Mutex_Lock(curRequestMutex);
 	{
-		*reqID    = http_curRequest.id;
-		*progress = http_curRequest.progress;
+		for (i = 0; i < HTTP_MAX_WORKERS && !(*reqID); i++)
+		{
+			for (j = 0; j < HTTP_MAX_PIPELINE; j++)
+			{
+				if (!http_workers[i].requests[j].id) continue;
+
+				*reqID    = http_workers[i].requests[j].id;
+				*progress = http_workers[i].requests[j].progress;
+				break;
+			}
+		}
 	}
 	Mutex_Unlock(curRequestMutex);
 	return *reqID != 0;
 }
 
 int Http_CheckProgress(int reqID) {
-	int curReqID, progress;
-	Http_GetCurrent(&curReqID, &progress);
+	struct HttpRequest* req;
+	cc_bool* cancelled;
+	int progress = HTTP_PROGRESS_NOT_WORKING_ON;
+	if (!reqID) return progress;
 
-	if (reqID != curReqID) progress = HTTP_PROGRESS_NOT_WORKING_ON;
+	Mutex_Lock(curRequestMutex);
+	{
+		req = HttpWorker_FindRequest(reqID, &cancelled);
+		if (req) progress = req->progress;
+	}
+	Mutex_Unlock(curRequestMutex);
 	return progress;
 }
 
@@ -770,91 +1022,752 @@ void Http_ClearPending(void) {
 }
 
 void Http_TryCancel(int reqID) {
+	cc_bool* cancelled;
+	if (!reqID) return;
+
 	Mutex_Lock(pendingMutex);
 	{
 		RequestList_TryFree(&pendingReqs, reqID);
 	}
 	Mutex_Unlock(pendingMutex);
 
-	Mutex_Lock(processedMutex);
+	/* NOTE: Workers only move finished requests into the processed list while holding curRequestMutex */
+	/*  so a request is always either still being processed, or already in the processed list here */
+	Mutex_Lock(curRequestMutex);
 	{
-		RequestList_TryFree(&processedReqs, reqID);
+		if (HttpWorker_FindRequest(reqID, &cancelled)) *cancelled = true;
+
+		Mutex_Lock(processedMutex);
+		{
+			RequestList_TryFree(&processedReqs, reqID);
+		}
+		Mutex_Unlock(processedMutex);
 	}
-	Mutex_Unlock(processedMutex);
+	Mutex_Unlock(curRequestMutex);
+}
+
+
+/*########################################################################################################################*
+*-----------------------------------------------------Http disk cache-----------------------------------------------------*
+*#########################################################################################################################*/
+/* Responses are stored in files named after the CRC32 and size of their contents, */
+/*  so identical responses from different URLs (e.g. the same skin under multiple names) are only stored once */
+#define HTTPCACHE_DIR   "httpcache"
+#define HTTPCACHE_INDEX "httpcache/index.txt"
+#if CC_BUILD_MAXSTACK <= (48 * 1024)
+	#define HTTPCACHE_MAX_ENTRIES 256
+#else
+	#define HTTPCACHE_MAX_ENTRIES 1024
+#endif
+/* Minimum time between writing the list of cached responses to disk */
+#define HTTPCACHE_SAVE_INTERVAL_MS (10 * 1000)
+
+struct HttpCacheEntry {
+	cc_uint32 urlHash;  /* CRC32 of the URL the response was downloaded from */
+	cc_uint32 bodyHash; /* CRC32 of the response contents */
+	cc_uint32 size;     /* Size of the response contents */
+	cc_uint32 lastUsed; /* Value of cache_clock when the response was last used */
+	char etag[STRING_SIZE];
+	char lastModified[STRING_SIZE];
+	char url[URL_MAX_SIZE]; /* Checked when finding entries, as different URLs may have the same CRC32 */
+};
+
+static void* cacheMutex;
+/* Serialises writing the list of cached responses, which is done without holding cacheMutex */
+static void* cacheSaveMutex;
+static struct HttpCacheEntry* cache_entries;
+static int cache_count;
+/* Total size of all stored response contents, and maximum allowed total size */
+static cc_uint32 cache_size, cache_maxSize;
+static cc_uint32 cache_clock;
+static cc_bool cache_dirty;
+static cc_uint64 cache_lastSave;
+
+static cc_uint32 HttpCache_HashUrl(const cc_string* url) {
+	return Utils_CRC32((const cc_uint8*)url->buffer, url->length);
+}
+
+static int HttpCache_Find(const cc_string* url, cc_uint32 urlHash) {
+	cc_string entryUrl;
+	int i;
+	for (i = 0; i < cache_count; i++) 
+	{
+		if (cache_entries[i].urlHash != urlHash) continue;
+
+		entryUrl = String_FromRawArray(cache_entries[i].url);
+		if (String_Equals(&entryUrl, url)) return i;
+	}
+	return -1;
+}
+
+/* Whether any cache entry has the same response contents as the given entry */
+static cc_bool HttpCache_HasBody(const struct HttpCacheEntry* e) {
+	int i;
+	for (i = 0; i < cache_count; i++) 
+	{
+		if (cache_entries[i].bodyHash == e->bodyHash && cache_entries[i].size == e->size) return true;
+	}
+	return false;
+}
+
+static void HttpCache_GetPath(const struct HttpCacheEntry* e, cc_string* path) {
+	String_Format2(path, HTTPCACHE_DIR "/%h%h", &e->bodyHash, &e->size);
+}
+
+/* Response contents are first written to a temp file unique to the request, then renamed once complete */
+static void HttpCache_GetTempPath(const struct HttpCacheEntry* e, struct HttpRequest* req, cc_string* path) {
+	String_Format3(path, HTTPCACHE_DIR "/%h%h_%i.tmp", &e->bodyHash, &e->size, &req->id);
+}
+
+/* Parses a 32 bit value written as 8 hexadecimal digits */
+static cc_bool HttpCache_ParseHex(const cc_string* str, cc_uint32* value) {
+	int i, digits[8];
+	*value = 0;
+	if (str->length != 8 || !PackedCol_Unhex(str->buffer, digits, 8)) return false;
+
+	for (i = 0; i < 8; i++) { *value = (*value << 4) | digits[i]; }
+	return true;
+}
+
+/* Deletes the stored response contents of the given entry, if no other entry has the same contents */
+static void HttpCache_ReleaseBody(const struct HttpCacheEntry* e) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_filepath raw_path;
+	cc_file file;
+	cc_result res;
+	if (HttpCache_HasBody(e)) return;
+
+	String_InitArray(path, pathBuffer);
+	HttpCache_GetPath(e, &path);
+	Platform_EncodePath(&raw_path, &path);
+
+	res = File_Delete(&raw_path);
+	/* Can still reclaim the disk space when the platform can't delete files */
+	if (res == ERR_NOT_SUPPORTED && !(res = File_Create(&file, &raw_path))) res = File_Close(file);
+
+	if (res && !ReturnCode_IsNotFound(res)) Logger_IOWarn2(res, "deleting", &raw_path);
+	cache_size -= e->size;
+}
+
+static void HttpCache_Remove(int i) {
+	struct HttpCacheEntry entry = cache_entries[i];
+	cache_entries[i] = cache_entries[--cache_count];
+	cache_dirty      = true;
+
+	HttpCache_ReleaseBody(&entry);
+}
+
+static void HttpCache_RemoveOldest(void) {
+	int i, oldest = 0;
+	for (i = 1; i < cache_count; i++) 
+	{
+		if (cache_entries[i].lastUsed < cache_entries[oldest].lastUsed) oldest = i;
+	}
+	HttpCache_Remove(oldest);
+}
+
+/* Reads the stored response contents of the given entry, checking they haven't been corrupted */
+static cc_result HttpCache_ReadBody(const struct HttpCacheEntry* e, cc_uint8** data) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_filepath raw_path;
+	struct Stream stream;
+	cc_result res;
+
+	String_InitArray(path, pathBuffer);
+	HttpCache_GetPath(e, &path);
+	Platform_EncodePath(&raw_path, &path);
+	if ((res = Stream_OpenPath(&stream, &raw_path))) return res;
+
+	*data = (cc_uint8*)Mem_TryAlloc(e->size, 1);
+	res   = *data ? Stream_Read(&stream, *data, e->size) : ERR_OUT_OF_MEMORY;
+	if (!res && Utils_CRC32(*data, e->size) != e->bodyHash) res = ERR_END_OF_STREAM;
+
+	if (res) { Mem_Free(*data); *data = NULL; }
+	/* No point logging error for closing readonly file */
+	(void)stream.Close(&stream);
+	return res;
+}
+
+/* Checks that the existing stored response contents of the given entry are the same as the response */
+/*  contents of the given request, and not just a CRC32 collision */
+static cc_bool HttpCache_SameBody(const struct HttpCacheEntry* e, struct HttpRequest* req) {
+	cc_uint8* data;
+	cc_bool same;
+	if (HttpCache_ReadBody(e, &data)) return false;
+
+	same = Mem_Equal(data, req->data, e->size);
+	Mem_Free(data);
+	return same;
+}
+
+static cc_bool HttpCache_WriteTemp(struct HttpRequest* req, const cc_string* tmpPath) {
+	cc_result res = Stream_WriteAllTo(tmpPath, req->data, req->size);
+	if (res) { Logger_SysWarn2(res, "caching", tmpPath); return false; }
+	return true;
+}
+
+/* Moves the temp file with the response contents of the given entry to where cache entries read it from */
+/* NOTE: Must be called while holding cacheMutex */
+static cc_bool HttpCache_AddBody(const struct HttpCacheEntry* e, cc_bool existing, const cc_string* tmpPath) {
+	cc_string path; char pathBuffer[FILENAME_SIZE];
+	cc_filepath raw_path, raw_tmpPath;
+	cc_result res;
+
+	/* Another worker may have removed or stored the same contents in the meantime */
+	if (HttpCache_HasBody(e)) return existing;
+	if (existing) return false;
+
+	String_InitArray(path, pathBuffer);
+	HttpCache_GetPath(e, &path);
+	Platform_EncodePath(&raw_path,    &path);
+	Platform_EncodePath(&raw_tmpPath, tmpPath);
+
+	res = File_Rename(&raw_tmpPath, &raw_path);
+	if (res) {
+		if (res != ERR_NOT_SUPPORTED) Logger_IOWarn2(res, "replacing", &raw_path);
+		return false;
+	}
+
+	cache_size += e->size;
+	return true;
+}
+
+/* Stores the response contents of the request on disk, then adds or updates the entry for its URL */
+/* NOTE: Must be called without holding cacheMutex, as reading/writing the contents can be slow */
+static void HttpCache_Store(struct HttpRequest* req, const cc_string* url, cc_uint32 urlHash) {
+	cc_string tmpPath; char tmpBuffer[FILENAME_SIZE];
+	cc_string etag = String_FromRawArray(req->etag);
+	struct HttpCacheEntry entry, old;
+	cc_bool cache, existing = false, stored;
+	cc_filepath raw_path;
+	int i;
+
+	/* No point caching responses which can't be revalidated or would evict most of the cache */
+	/* NOTE: ETag/URL can't contain spaces, as the list of cached responses is space separated */
+	cache = (req->etag[0] || req->lastModified[0]) && req->size <= cache_maxSize / 4
+		&& String_IndexOf(&etag, ' ') == -1 && String_IndexOf(url, ' ') == -1;
+
+	entry.urlHash  = urlHash;
+	entry.bodyHash = Utils_CRC32(req->data, req->size);
+	entry.size     = req->size;
+	Mem_Copy(entry.etag,         req->etag,         sizeof(entry.etag));
+	Mem_Copy(entry.lastModified, req->lastModified, sizeof(entry.lastModified));
+	Mem_Copy(entry.url,          req->url,          sizeof(entry.url));
+
+	String_InitArray(tmpPath, tmpBuffer);
+	HttpCache_GetTempPath(&entry, req, &tmpPath);
+
+	if (cache) {
+		Mutex_Lock(cacheMutex);
+		{
+			existing = HttpCache_HasBody(&entry);
+		}
+		Mutex_Unlock(cacheMutex);
+
+		cache = existing ? HttpCache_SameBody(&entry, req) : HttpCache_WriteTemp(req, &tmpPath);
+	}
+
+	Mutex_Lock(cacheMutex);
+	{
+		stored = cache && HttpCache_AddBody(&entry, existing, &tmpPath);
+		i      = HttpCache_Find(url, urlHash);
+
+		entry.lastUsed = ++cache_clock;
+
+		if (!stored) {
+			if (i >= 0) HttpCache_Remove(i);
+		} else if (i >= 0) {
+			old              = cache_entries[i];
+			cache_entries[i] = entry;
+			HttpCache_ReleaseBody(&old);
+			cache_dirty      = true;
+		} else {
+			if (cache_count == HTTPCACHE_MAX_ENTRIES) HttpCache_RemoveOldest();
+			cache_entries[cache_count++] = entry;
+			cache_dirty = true;
+		}
+
+		while (cache_size > cache_maxSize && cache_count > 1) { HttpCache_RemoveOldest(); }
+	}
+	Mutex_Unlock(cacheMutex);
+
+	if (cache && !existing && !stored) {
+		Platform_EncodePath(&raw_path, &tmpPath);
+		(void)File_Delete(&raw_path);
+	}
+}
+
+/* Replaces the body-less response to a revalidation request with the stored response contents */
+/* NOTE: Must be called without holding cacheMutex, as reading the contents can be slow */
+static cc_bool HttpCache_Use(struct HttpRequest* req, const struct HttpCacheEntry* e, const cc_string* url) {
+	struct HttpCacheEntry* cur;
+	cc_result res;
+	int i;
+
+	HttpRequest_Free(req);
+	res = HttpCache_ReadBody(e, &req->data);
+
+	Mutex_Lock(cacheMutex);
+	{
+		i   = HttpCache_Find(url, e->urlHash);
+		cur = i >= 0 ? &cache_entries[i] : NULL;
+
+		/* Entry may have been replaced or removed by another worker in the meantime */
+		if (cur && cur->bodyHash == e->bodyHash && cur->size == e->size) {
+			if (res) {
+				HttpCache_Remove(i);
+			} else {
+				cur->lastUsed = ++cache_clock;
+				cache_dirty   = true;
+			}
+		}
+	}
+	Mutex_Unlock(cacheMutex);
+
+	if (res) { Platform_Log1("HTTP: discarding cached %c", req->url); return false; }
+	req->size          = e->size;
+	req->_capacity     = e->size;
+	req->contentLength = e->size;
+	req->statusCode    = 200;
+	return true;
+}
+
+static void HttpCache_WriteIndex(struct HttpCacheEntry* entries, int count) {
+	cc_string line; char lineBuffer[STRING_SIZE * 5];
+	cc_string path = String_FromConst(HTTPCACHE_INDEX);
+	cc_string url, etag, lastModified;
+	struct HttpCacheEntry* e;
+	struct Stream stream;
+	cc_filepath raw_path;
+	cc_result res;
+	int i;
+
+	Platform_EncodePath(&raw_path, &path);
+	res = Stream_CreatePath(&stream, &raw_path);
+	if (res) { Logger_IOWarn2(res, "creating", &raw_path); return; }
+
+	for (i = 0; i < count; i++) 
+	{
+		e = &entries[i];
+		String_InitArray(line, lineBuffer);
+		url          = String_FromRawArray(e->url);
+		etag         = String_FromRawArray(e->etag);
+		lastModified = String_FromRawArray(e->lastModified);
+		if (!etag.length) etag = String_FromReadonly("-");
+
+		String_Format4(&line, "%h %h %h %h", &e->urlHash, &e->bodyHash, &e->size, &e->lastUsed);
+		String_Format3(&line, " %s %s %s", &url, &etag, &lastModified);
+
+		res = Stream_WriteLine(&stream, &line);
+		if (res) { Logger_IOWarn2(res, "writing to", &raw_path); break; }
+	}
+
+	res = stream.Close(&stream);
+	if (res) { Logger_IOWarn2(res, "closing", &raw_path); }
+}
+
+/* Writes a copy of the list of cached responses to disk */
+/* NOTE: Must be called without holding cacheMutex, as writing the list can be slow */
+static void HttpCache_Save(void) {
+	struct HttpCacheEntry* entries;
+	int count;
+
+	Mutex_Lock(cacheSaveMutex);
+	Mutex_Lock(cacheMutex);
+	{
+		count   = cache_count;
+		entries = (struct HttpCacheEntry*)Mem_TryAlloc(max(count, 1), sizeof(struct HttpCacheEntry));
+
+		if (entries) {
+			Mem_Copy(entries, cache_entries, count * sizeof(struct HttpCacheEntry));
+			cache_dirty = false;
+		}
+		cache_lastSave = Stopwatch_Measure();
+	}
+	Mutex_Unlock(cacheMutex);
+
+	if (entries) HttpCache_WriteIndex(entries, count);
+	Mem_Free(entries);
+	Mutex_Unlock(cacheSaveMutex);
+}
+
+/* Parses a line in the list of cached responses */
+/* (urlHash bodyHash size lastUsed url etag lastModified, with etag being - if there is no ETag) */
+static void HttpCache_ParseEntry(const cc_string* line) {
+	struct HttpCacheEntry* e = &cache_entries[cache_count];
+	cc_string parts[7];
+	if (cache_count == HTTPCACHE_MAX_ENTRIES) return;
+
+	if (String_UNSAFE_Split(line, ' ', parts, 7) < 7) return;
+	if (!HttpCache_ParseHex(&parts[0], &e->urlHash))  return;
+	if (!HttpCache_ParseHex(&parts[1], &e->bodyHash)) return;
+	if (!HttpCache_ParseHex(&parts[2], &e->size))     return;
+	if (!HttpCache_ParseHex(&parts[3], &e->lastUsed)) return;
+
+	/* Also skips entries from older versions, which didn't store the URL */
+	if (parts[4].length >= URL_MAX_SIZE || HttpCache_HashUrl(&parts[4]) != e->urlHash) return;
+	if (HttpCache_Find(&parts[4], e->urlHash) >= 0) return;
+
+	if (String_CaselessEqualsConst(&parts[5], "-")) parts[5].length = 0;
+	String_CopyToRawArray(e->url,          &parts[4]);
+	String_CopyToRawArray(e->etag,         &parts[5]);
+	String_CopyToRawArray(e->lastModified, &parts[6]);
+
+	if (!HttpCache_HasBody(e)) cache_size += e->size;
+	cache_clock = max(cache_clock, e->lastUsed);
+	cache_count++;
+}
+
+/* Deletes stored response contents that aren't in the list of cached responses */
+/*  (e.g. when the game exited before the list was saved) */
+static void HttpCache_CleanFile(const cc_string* path, void* obj, int isDirectory) {
+	static const cc_string tmpExt = String_FromConst(".tmp");
+	struct HttpCacheEntry e;
+	cc_string name = *path, part;
+	cc_filepath raw_path;
+	Utils_UNSAFE_GetFilename(&name);
+	if (isDirectory) return;
+
+	/* Temp files are left behind when the game exits while writing response contents */
+	if (String_CaselessEnds(&name, &tmpExt)) {
+		Platform_EncodePath(&raw_path, path);
+		(void)File_Delete(&raw_path); return;
+	}
+	if (name.length != 16) return;
+
+	part = String_UNSAFE_Substring(&name, 0, 8);
+	if (!HttpCache_ParseHex(&part, &e.bodyHash)) return;
+	part = String_UNSAFE_Substring(&name, 8, 8);
+	if (!HttpCache_ParseHex(&part, &e.size))     return;
+	if (HttpCache_HasBody(&e)) return;
+
+	Platform_EncodePath(&raw_path, path);
+	(void)File_Delete(&raw_path);
+}
+
+/* Response contents are written to temp files that are then renamed or deleted, */
+/*  so the cache can't be used on platforms that don't support renaming or deleting files */
+static cc_bool HttpCache_CanRenameFiles(void) {
+	static const cc_string path = String_FromConst(HTTPCACHE_DIR "/probe.tmp");
+	cc_filepath raw_path;
+	Platform_EncodePath(&raw_path, &path);
+
+	return File_Rename(&raw_path, &raw_path) != ERR_NOT_SUPPORTED && File_Delete(&raw_path) != ERR_NOT_SUPPORTED;
+}
+
+static void HttpCache_Init(void) {
+	static const cc_string dir = String_FromConst(HTTPCACHE_DIR);
+	struct StringsBuffer lines;
+	int i;
+
+	cacheMutex     = Mutex_Create("HTTP cache");
+	cacheSaveMutex = Mutex_Create("HTTP cache save");
+	cache_maxSize  = Options_GetInt(OPT_HTTP_CACHE_SIZE, 0, 1024, 32) * 1024 * 1024;
+	if (!cache_maxSize || Platform_ReadonlyFilesystem) return;
+	if (!HttpCache_CanRenameFiles()) return;
+	if (!Utils_EnsureDirectory(HTTPCACHE_DIR)) return;
+
+	cache_entries = (struct HttpCacheEntry*)Mem_TryAlloc(HTTPCACHE_MAX_ENTRIES, sizeof(struct HttpCacheEntry));
+	if (!cache_entries) return;
+
+	StringsBuffer_SetLengthBits(&lines, STRINGSBUFFER_DEF_LEN_SHIFT);
+	StringsBuffer_Init(&lines);
+	EntryList_UNSAFE_Load(&lines, HTTPCACHE_INDEX);
+	for (i = 0; i < lines.count; i++) 
+	{
+		cc_string line = StringsBuffer_UNSAFE_Get(&lines, i);
+		HttpCache_ParseEntry(&line);
+	}
+	StringsBuffer_Clear(&lines);
+
+	Directory_Enum(&dir, NULL, HttpCache_CleanFile);
+	while (cache_size > cache_maxSize && cache_count > 1) { HttpCache_RemoveOldest(); }
+	Platform_Log2("HTTP: %i cached responses (%i bytes)", &cache_count, &cache_size);
+}
+
+/* Sends the ETag/Last-Modified of the cached response (if any) in the request, */
+/*  so that the server only sends the response contents again if they have since changed */
+static void HttpCache_Prepare(struct HttpRequest* req) {
+	cc_string url = String_FromRawArray(req->url);
+	struct HttpCacheEntry* e;
+	int i;
+	if (!req->diskCache || !cache_entries) return;
+
+	Mutex_Lock(cacheMutex);
+	{
+		i = HttpCache_Find(&url, HttpCache_HashUrl(&url));
+
+		if (i >= 0) {
+			e = &cache_entries[i];
+			Mem_Copy(req->etag,         e->etag,         sizeof(req->etag));
+			Mem_Copy(req->lastModified, e->lastModified, sizeof(req->lastModified));
+		}
+	}
+	Mutex_Unlock(cacheMutex);
+}
+
+/* Returns whether the request must be performed again, because the stored response contents */
+/*  are no longer available (e.g. evicted by another request or corrupted) */
+static cc_bool HttpCache_Finish(struct HttpRequest* req) {
+	cc_string url = String_FromRawArray(req->url);
+	cc_bool retry = false, store, found = false, save;
+	struct HttpCacheEntry entry;
+	cc_uint32 urlHash;
+	int i;
+	if (!req->diskCache || !cache_entries || req->result) return false;
+
+	urlHash = HttpCache_HashUrl(&url);
+	store   = req->statusCode == 200 && req->data && req->size;
+	if (store) HttpCache_Store(req, &url, urlHash);
+
+	Mutex_Lock(cacheMutex);
+	{
+		i = store ? -1 : HttpCache_Find(&url, urlHash);
+
+		if (req->statusCode == 304) {
+			found = i >= 0;
+			if (found) entry = cache_entries[i];
+		} else if (i >= 0) {
+			HttpCache_Remove(i);
+		}
+	}
+	Mutex_Unlock(cacheMutex);
+
+	if (req->statusCode == 304) retry = !found || !HttpCache_Use(req, &entry, &url);
+
+	Mutex_Lock(cacheMutex);
+	{
+		save = cache_dirty && Stopwatch_ElapsedMS(cache_lastSave, Stopwatch_Measure()) >= HTTPCACHE_SAVE_INTERVAL_MS;
+	}
+	Mutex_Unlock(cacheMutex);
+	if (save) HttpCache_Save();
+
+	if (retry) { req->etag[0] = '\0'; req->lastModified[0] = '\0'; }
+	return retry;
+}
+
+static void HttpCache_Free(void) {
+	cc_bool save;
+	if (!cache_entries) return;
+
+	Mutex_Lock(cacheMutex);
+	{
+		save = cache_dirty;
+	}
+	Mutex_Unlock(cacheMutex);
+	if (save) HttpCache_Save();
 }
 
 
 /*########################################################################################################################*
 *-----------------------------------------------------Http worker---------------------------------------------------------*
 *#########################################################################################################################*/
+/* Returns the scheme and address of the server a request is sent to (e.g. "https://classicube.net:8080") */
+static cc_string HttpWorker_GetOrigin(struct HttpRequest* req) {
+	cc_string url = String_FromRawArray(req->url);
+	int beg = String_IndexOfConst(&url, "://"), end;
+	beg = beg >= 0 ? beg + 3 : 0;
+
+	for (end = beg; end < url.length && url.buffer[end] != '/'; end++) { }
+	return String_UNSAFE_Substring(&url, 0, end);
+}
+
+static cc_bool HttpWorker_IsBusy(struct HttpWorker* worker) {
+	int i;
+	for (i = 0; i < HTTP_MAX_PIPELINE; i++)
+	{
+		if (worker->requests[i].id) return true;
+	}
+	return false;
+}
+
+static int HttpWorker_CountOrigin(const cc_string* origin) {
+	int i, count = 0;
+
+	for (i = 0; i < HTTP_MAX_WORKERS; i++)
+	{
+		if (!HttpWorker_IsBusy(&http_workers[i])) continue;
+		if (String_CaselessEquals(&http_workers[i].origin, origin)) count++;
+	}
+	return count;
+}
+
+/* Whether the request can be sent while responses to other requests are still being received */
+static cc_bool HttpWorker_CanPipeline(struct HttpRequest* req) {
+	return req->requestType != REQUEST_TYPE_POST && !req->data && !req->cookies;
+}
+
 /* Sets up state to begin a http request */
-static void SetCurrentRequest(struct HttpRequest* req) {
-	Mutex_Lock(curRequestMutex);
+static void HttpWorker_AddRequest(struct HttpWorker* worker, struct HttpRequest* req) {
+	int i = worker->numRequests++;
+
+	HttpRequest_Copy(&worker->requests[i], req);
+	worker->requests[i].progress = HTTP_PROGRESS_MAKING_REQUEST;
+	worker->cancelled[i]         = false;
+}
+
+/* Takes the highest priority pending request whose server isn't already being sent too many requests */
+/* When pipelining, also takes other pending requests to the same server */
+/* NOTE: Must be called while holding both pendingMutex and curRequestMutex */
+static cc_bool HttpWorker_TakeRequests(struct HttpWorker* worker) {
+	struct HttpRequest* req;
+	cc_string origin;
+	int i;
+	worker->numRequests = 0;
+
+	for (i = 0; i < pendingReqs.count; i++)
 	{
-		HttpRequest_Copy(&http_curRequest, req);
-		http_curRequest.progress = HTTP_PROGRESS_MAKING_REQUEST;
+		req    = &pendingReqs.entries[i];
+		origin = HttpWorker_GetOrigin(req);
+		if (HttpWorker_CountOrigin(&origin) >= HTTP_MAX_ORIGIN_WORKERS) continue;
+
+		String_InitArray(worker->origin, worker->_originBuffer);
+		String_Copy(&worker->origin, &origin);
+
+		HttpWorker_AddRequest(worker, req);
+		RequestList_RemoveAt(&pendingReqs, i);
+		break;
 	}
-	Mutex_Unlock(curRequestMutex);
+
+	if (!worker->numRequests) return false;
+	if (!http_pipelining || !HttpWorker_CanPipeline(&worker->requests[0])) return true;
+
+	for (i = 0; i < pendingReqs.count && worker->numRequests < HTTP_MAX_PIPELINE;)
+	{
+		req    = &pendingReqs.entries[i];
+		origin = HttpWorker_GetOrigin(req);
+
+		if (!HttpWorker_CanPipeline(req) || !String_CaselessEquals(&origin, &worker->origin)) {
+			i++; continue;
+		}
+
+		HttpWorker_AddRequest(worker, req);
+		RequestList_RemoveAt(&pendingReqs, i);
+	}
+	return true;
 }
 
-static void PerformRequest(struct HttpRequest* req) {
-	cc_uint64 beg, end;
+static void HttpWorker_FinishRequest(struct HttpWorker* worker, int i, cc_uint64 beg) {
+	struct HttpRequest* req = &worker->requests[i];
+	cc_uint64 end;
 	int elapsed;
 
-	beg = Stopwatch_Measure();
-	req->result = HttpBackend_Do(req);
-	end = Stopwatch_Measure();
-
+	if (HttpCache_Finish(req)) {
+		req->result = HttpBackend_Do(req);
+		HttpCache_Finish(req);
+	}
+	end     = Stopwatch_Measure();
 	elapsed = Stopwatch_ElapsedMS(beg, end);
+
 	Platform_Log4("HTTP: result %e (http %i) in %i ms (%i bytes)",
 		&req->result, &req->statusCode, &elapsed, &req->size);
 
-	Http_FinishRequest(req);
-}
-
-static void ClearCurrentRequest(void) {
 	Mutex_Lock(curRequestMutex);
 	{
-		http_curRequest.id       = 0;
-		http_curRequest.progress = HTTP_PROGRESS_NOT_WORKING_ON;
+		if (worker->cancelled[i]) {
+			HttpRequest_Free(req);
+		} else {
+			Http_FinishRequest(req);
+		}
+
+		req->id       = 0;
+		req->progress = HTTP_PROGRESS_NOT_WORKING_ON;
 	}
 	Mutex_Unlock(curRequestMutex);
 }
 
+/* NOTE: Pipelined requests never have cookies (see HttpWorker_CanPipeline) */
+static cc_result HttpWorker_Do(struct HttpRequest* req) {
+	cc_result res;
+	if (!req->cookies) return HttpBackend_Do(req);
+
+	Mutex_Lock(cookiesMutex);
+	{
+		res = HttpBackend_Do(req);
+	}
+	Mutex_Unlock(cookiesMutex);
+	return res;
+}
+
+static void PerformRequests(struct HttpWorker* worker) {
+	cc_uint64 beg;
+	int i, received;
+
+	/* Not done in HttpWorker_AddRequest, since the request queue locks are held there */
+	for (i = 0; i < worker->numRequests; i++) 
+	{
+		HttpCache_Prepare(&worker->requests[i]);
+	}
+	beg = Stopwatch_Measure();
+	i   = 0;
+
+	if (worker->numRequests > 1) {
+		received = HttpBackend_DoPipelined(worker->requests, worker->numRequests);
+		for (; i < received; i++) HttpWorker_FinishRequest(worker, i, beg);
+	}
+
+	/* Requests whose responses weren't received when pipelining are performed normally */
+	for (; i < worker->numRequests; i++)
+	{
+		beg = Stopwatch_Measure();
+		worker->requests[i].result = HttpWorker_Do(&worker->requests[i]);
+		HttpWorker_FinishRequest(worker, i, beg);
+	}
+}
+
+#if defined CC_BUILD_PSP || defined CC_BUILD_NDS
 static void DoRequest(struct HttpRequest* request) {
-	SetCurrentRequest(request);
-	PerformRequest(&http_curRequest);
-	ClearCurrentRequest();
+	struct HttpWorker* worker = &http_workers[0];
+	cc_string origin = HttpWorker_GetOrigin(request);
+
+	Mutex_Lock(curRequestMutex);
+	{
+		String_InitArray(worker->origin, worker->_originBuffer);
+		String_Copy(&worker->origin, &origin);
+
+		worker->numRequests = 0;
+		HttpWorker_AddRequest(worker, request);
+	}
+	Mutex_Unlock(curRequestMutex);
+	PerformRequests(worker);
 }
+#endif
 
 static void WorkerLoop(void) {
-	struct HttpRequest request;
-	cc_bool hasRequest;
+	struct HttpWorker* worker;
+	cc_bool hasRequest, hasMore;
 
-	for (;;) {
-		hasRequest = false;
+	Mutex_Lock(curRequestMutex);
+	{
+		worker = &http_workers[http_startedWorkers++];
+	}
+	Mutex_Unlock(curRequestMutex);
 
+	for (;;) {
 		Mutex_Lock(pendingMutex);
+		Mutex_Lock(curRequestMutex);
 		{
-			if (pendingReqs.count) {
-				HttpRequest_Copy(&request, &pendingReqs.entries[0]);
-				hasRequest = true;
-				RequestList_RemoveAt(&pendingReqs, 0);
-			}
+			hasRequest = HttpWorker_TakeRequests(worker);
+			hasMore    = pendingReqs.count > 0;
 		}
+		Mutex_Unlock(curRequestMutex);
 		Mutex_Unlock(pendingMutex);
 
 		if (hasRequest) {
-			DoRequest(&request);
+			/* Wake up another worker to process the other pending requests */
+			if (hasMore) Waitable_Signal(workerWaitable);
+			PerformRequests(worker);
 		} else {
 			/* Block until another thread submits a request to do */
-			Platform_LogConst("Download queue empty, going back to sleep...");
+			/* NOTE: Pending requests skipped due to HTTP_MAX_ORIGIN_WORKERS are taken */
+			/*  by the workers processing requests to that server once they finish */
+			if (!hasMore) Platform_LogConst("Download queue empty, going back to sleep...");
 			Waitable_Wait(workerWaitable);
 		}
 	}
 }
 
-/* Adds a req to the list of pending requests, waking up worker thread if needed */
+/* Adds a req to the list of pending requests, waking up a worker thread if needed */
 static void HttpBackend_Add(struct HttpRequest* req, cc_uint8 flags) {
 #if defined CC_BUILD_PSP || defined CC_BUILD_NDS
 	/* TODO why doesn't threading work properly on PSP */
@@ -873,10 +1786,10 @@ static void HttpBackend_Add(struct HttpRequest* req, cc_uint8 flags) {
 *-----------------------------------------------------Http component------------------------------------------------------*
 *#########################################################################################################################*/
 static void Http_Init(void) {
+	int i, j;
 	Http_InitCommon();
-	http_curRequest.progress = HTTP_PROGRESS_NOT_WORKING_ON;
 	/* Http component gets initialised multiple times on Android */
-	if (workerThread) return;
+	if (http_numWorkers) return;
 
 	HttpBackend_Init();
 	RequestList_Init(&pendingReqs);
@@ -886,7 +1799,29 @@ static void Http_Init(void) {
 	pendingMutex    = Mutex_Create("HTTP pending");
 	processedMutex  = Mutex_Create("HTTP processed");
 	curRequestMutex = Mutex_Create("HTTP current");
+	poolMutex       = Mutex_Create("HTTP connections");
+	cookiesMutex    = Mutex_Create("HTTP cookies");
+	HttpCache_Init();
+
+	for (i = 0; i < HTTP_MAX_WORKERS; i++)
+		for (j = 0; j < HTTP_MAX_PIPELINE; j++)
+	{
+		http_workers[i].requests[j].progress = HTTP_PROGRESS_NOT_WORKING_ON;
+	}
 	
-	Thread_Run(&workerThread, WorkerLoop, 128 * 1024, "HTTP");
+	http_pipelining = Options_GetBool(OPT_HTTP_PIPELINING, false);
+	http_numWorkers = Options_GetInt(OPT_HTTP_WORKERS, 1, HTTP_MAX_WORKERS, HTTP_DEF_WORKERS);
+	for (i = 0; i < http_numWorkers; i++)
+	{
+		Thread_Run(&http_workers[i].thread, WorkerLoop, 128 * 1024, "HTTP");
+	}
+}
+
+static void Http_Free(void) {
+	Http_ClearPending();
+	HttpCache_Free();
+#if CC_NET_BACKEND == CC_NET_BACKEND_BUILTIN
+	ConnectionPool_LogStats();
+#endif
 }
 #endif
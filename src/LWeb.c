@@ -648,7 +648,7 @@ static void FetchFlagsTask_DownloadNext(void) {
 			&flags[FetchFlagsTask.count].country[0], &flags[FetchFlagsTask.count].country[1]);
 
 	FetchFlagsTask.Base.Handle = FetchFlagsTask_Handle;
-	FetchFlagsTask.Base.reqID  = Http_AsyncGetData(&url, 0);
+	FetchFlagsTask.Base.reqID  = Http_AsyncGetData(&url, HTTP_FLAG_BACKGROUND | HTTP_FLAG_DISKCACHE);
 }
 
 static void FetchFlagsTask_Ensure(void) {
@@ -12,6 +12,7 @@
 #include "ExtMath.h"
 #include "Options.h"
 #include "Builder.h"
+#include "Utils.h"
 
 const char* const LightingMode_Names[LIGHTING_MODE_COUNT] = { "Classic", "Fancy" };
 
@@ -386,6 +387,75 @@ void ClassicLighting_LightHint(int startX, int startY, int startZ) {
 	}
 }
 
+
+/* Eagerly calculates light heights for the entire map, so that work is not */
+/*  performed inside the first frames of building chunks instead */
+/* NOTE: Light heights calculated MUST be identical to ClassicLighting_CalcHeightAt */
+#if !defined CC_BUILD_LOWMEM && !defined CC_BUILD_COOPTHREADED
+/* Number of columns checked at once (one bit per column) */
+#define HEIGHTMAP_BATCH_SIZE 32
+
+#define Heightmap_BuildBody(get_block)\
+for (y = World.MaxY; y >= 0; y--) {\
+	/* Find which columns have a light blocking block in this layer */ \
+	i = World_Pack(x1, y, z);\
+	blocks = 0;\
+	for (x = 0; x < count; x++, i++) {\
+		blocks |= (cc_uint32)Blocks.BlocksLight[get_block] << x;\
+	}\
+\
+	blocks &= ~found;\
+	if (!blocks) continue;\
+	found |= blocks;\
+\
+	i = World_Pack(x1, y, z);\
+	for (x = 0; x < count; x++, i++) {\
+		if (!(blocks & (1u << x))) continue;\
+		block = get_block;\
+		offset = (Blocks.LightOffset[block] >> LIGHT_FLAG_SHADES_FROM_BELOW) & 1;\
+		classic_heightmap[hIndex + x] = y - offset;\
+	}\
+	if (found == all) return;\
+}
+
+static void Heightmap_BuildColumns(int x1, int z, int count) {
+	cc_uint32 all = count == HEIGHTMAP_BATCH_SIZE ? 0xFFFFFFFFU : (1u << count) - 1;
+	cc_uint32 found = 0, blocks;
+	int hIndex = Lighting_Pack(x1, z);
+	int x, y, i, offset;
+	BlockID block;
+
+#ifndef EXTENDED_BLOCKS
+	Heightmap_BuildBody(World.Blocks[i]);
+#else
+	if (World.IDMask <= 0xFF) {
+		Heightmap_BuildBody(World.Blocks[i]);
+	} else {
+		Heightmap_BuildBody(World.Blocks[i] | (World.Blocks2[i] << 8));
+	}
+#endif
+
+	for (x = 0; x < count; x++) {
+		if (!(found & (1u << x))) classic_heightmap[hIndex + x] = -10;
+	}
+}
+
+static void Heightmap_BuildRow(int z) {
+	int x, count;
+	for (x = 0; x < World.Width; x += count) {
+		count = min(World.Width - x, HEIGHTMAP_BATCH_SIZE);
+		Heightmap_BuildColumns(x, z, count);
+	}
+}
+
+static void ClassicLighting_BuildHeightmap(void) {
+	Utils_ParallelFor(World.Length, Heightmap_BuildRow, NULL);
+}
+#else
+/* Not worth delaying map loading on less powerful systems */
+static void ClassicLighting_BuildHeightmap(void) { ClassicLighting_Refresh(); }
+#endif
+
 void ClassicLighting_FreeState(void) {
 	Mem_Free(classic_heightmap);
 	classic_heightmap = NULL;
@@ -394,7 +464,7 @@ void ClassicLighting_FreeState(void) {
 void ClassicLighting_AllocState(void) {
 	classic_heightmap = (cc_int16*)Mem_TryAlloc(World.Width * World.Length, 2);
 	if (classic_heightmap) {
-		ClassicLighting_Refresh();
+		ClassicLighting_BuildHeightmap();
 	} else {
 		World_OutOfMemory();
 	}
@@ -84,6 +84,9 @@ static const char* GetCCErrorDesc(cc_result res) {
 	case CW_ERR_ROOT_TAG:   return "Invalid root NBT tag";
 	case CW_ERR_STRING_LEN: return "NBT string too long";
 
+	case CCR_ERR_INVALID_HDR: return "Invalid or unsupported region map header";
+	case CCR_ERR_REGION_DATA: return "Corrupted region map data";
+
 	case ERR_DOWNLOAD_INVALID: return "Website denied download or doesn't exist";
 	case ERR_NO_AUDIO_OUTPUT:  return "No audio output devices plugged in";
 	case ERR_INVALID_DATA_URL: return "Cannot download from invalid URL";
@@ -1388,17 +1388,35 @@ static cc_result DoSaveMap(const cc_string* path, struct GZipState* state) {
 }
 
 static cc_result SaveLevelScreen_SaveMap(const cc_string* path) {
+	static const cc_string cw  = String_FromConst(".cw");
+	static const cc_string ccr = String_FromConst(".ccr");
 	struct GZipState* state;
 	cc_result res;
 
-	state = (struct GZipState*)Mem_TryAlloc(1, sizeof(struct GZipState));
-	res   = ERR_OUT_OF_MEMORY;
-	if (!state) { Logger_SysWarn(res, "allocating temp memory"); return res; }
+	/* Fast load cache isn't saved, as the world may change before the background save completes */
+	if (String_CaselessEnds(path, &cw) && Options_GetBool(OPT_MAP_BACKGROUND_SAVE, false)) {
+		res = Cw_SaveInBackground(path);
+		if (!res) { Gui_ShowPauseMenu(); return 0; }
+		if (res != ERR_NOT_SUPPORTED) return res;
+	}
+
+	if (String_CaselessEnds(path, &ccr)) {
+		/* Region maps are updated in place, so usually only changed regions are written */
+		res = Ccr_Save(path);
+	} else {
+		state = (struct GZipState*)Mem_TryAlloc(1, sizeof(struct GZipState));
+		res   = ERR_OUT_OF_MEMORY;
+		if (!state) { Logger_SysWarn(res, "allocating temp memory"); return res; }
 
-	res = DoSaveMap(path, state);
-	Mem_Free(state);
+		res = DoSaveMap(path, state);
+		Mem_Free(state);
+	}
 	if (res) return res;
 
+	if (String_CaselessEnds(path, &cw) && Options_GetBool(OPT_MAP_FASTLOAD, false)) {
+		Map_SaveCache(path);
+	}
+
 	World.LastSave = Game.Time;
 	Gui_ShowPauseMenu();
 	return 0;
@@ -1416,6 +1434,10 @@ static void SaveLevelScreen_Save(void* screen, void* widget) {
 		TextWidget_SetConst(&s->desc, "&ePlease enter a filename", &s->textFont);
 		return;
 	}
+	if (Cw_IsSavingInBackground()) {
+		TextWidget_SetConst(&s->desc, "&eMap is still being saved", &s->textFont);
+		return;
+	}
 
 	String_InitArray(path, pathBuffer);
 	String_Format1(&path, "maps/%s.cw", &file);
@@ -1431,24 +1453,31 @@ static void SaveLevelScreen_Save(void* screen, void* widget) {
 	SaveLevelScreen_RemoveOverwrites(s);
 	if ((res = SaveLevelScreen_SaveMap(&path))) return;
 
+	/* Background saves notify the server once the map has actually been saved */
+	if (Cw_IsSavingInBackground()) {
+		Chat_Add1("&eSaving map to: %s", &path); return;
+	}
 	Chat_Add1("&eSaved map to: %s", &path);
 	CPE_SendNotifyAction(NOTIFY_ACTION_LEVEL_SAVED, 0);
 }
 
 static void SaveLevelScreen_UploadCallback(const cc_string* path) {
 	cc_result res = SaveLevelScreen_SaveMap(path);
-	if (!res) {
-		Chat_Add1("&eSaved map to: %s", path);
-		CPE_SendNotifyAction(NOTIFY_ACTION_LEVEL_SAVED, 0);
+	if (res) return;
+
+	if (Cw_IsSavingInBackground()) {
+		Chat_Add1("&eSaving map to: %s", path); return;
 	}
+	Chat_Add1("&eSaved map to: %s", path);
+	CPE_SendNotifyAction(NOTIFY_ACTION_LEVEL_SAVED, 0);
 }
 
 static void SaveLevelScreen_File(void* screen, void* b) {
 	static const char* const titles[] = {
-		"ClassiCube map", "Minecraft schematic", "Minecraft classic map", NULL
+		"ClassiCube map", "ClassiCube region map", "Minecraft schematic", "Minecraft classic map", NULL
 	};
 	static const char* const filters[] = {
-		".cw", ".schematic", ".mine", NULL
+		".cw", ".ccr", ".schematic", ".mine", NULL
 	};
 	struct SaveLevelScreen* s = (struct SaveLevelScreen*)screen;
 	struct SaveFileDialogArgs args;
@@ -1846,7 +1875,7 @@ static void LoadLevelScreen_LoadEntries(struct ListScreen* s) {
 static void LoadLevelScreen_UploadCallback(const cc_string* path) { Map_LoadFrom(path); }
 static void LoadLevelScreen_ActionFunc(void* s, void* w) {
 	static const char* const filters[] = { 
-		".cw", ".dat", ".lvl", ".mine", ".fcm", ".mclevel", NULL 
+		".cw", ".dat", ".lvl", ".mine", ".fcm", ".mclevel", ".ccr", NULL 
 	}; /* TODO not hardcode list */
 	static struct OpenFileDialogArgs args = {
 		"Classic map files", filters,
@@ -16,6 +16,8 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 
 #define OPT_VIEW_DISTANCE "viewdist"
 #define OPT_BLOCK_PHYSICS "singleplayerphysics"
+#define OPT_MAP_FASTLOAD "map-fastloadcache"
+#define OPT_MAP_BACKGROUND_SAVE "map-backgroundsave"
 #define OPT_NAMES_MODE "namesmode"
 #define OPT_INVERT_MOUSE "invertmouse"
 #define OPT_SENSITIVITY "mousesensitivity"
@@ -72,6 +74,7 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 #define OPT_CLASSIC_CHAT "nostalgia-classicchat"
 #define OPT_CLASSIC_INVENTORY "nostalgia-classicinventory"
 #define OPT_MAX_CHUNK_UPDATES "gfx-maxchunkupdates"
+#define OPT_SKIN_UPLOAD_KB "gfx-skinuploadkb"
 #define OPT_CAMERA_MASS "cameramass"
 #define OPT_CAMERA_SMOOTH "camera-smooth"
 #define OPT_GRAB_CURSOR "win-grab-cursor"
@@ -81,6 +84,9 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 #define OPT_HTTP_ONLY "http-no-https"
 #define OPT_HTTPS_VERIFY "https-verify"
 #define OPT_SKIN_SERVER "http-skinserver"
+#define OPT_HTTP_WORKERS "http-workers"
+#define OPT_HTTP_PIPELINING "http-pipelining"
+#define OPT_HTTP_CACHE_SIZE "http-cache-size"
 #define OPT_RAW_INPUT "win-raw-input"
 #define OPT_DPI_SCALING "win-dpi-scaling"
 #define OPT_GAME_VERSION "game-version"
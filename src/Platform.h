@@ -301,6 +301,16 @@ cc_result File_Seek(cc_file file, int offset, int seekType);
 cc_result File_Position(cc_file file, cc_uint32* pos);
 /* Attempts to retrieve the length of the given file. */
 cc_result File_Length(cc_file file, cc_uint32* len);
+/* Attempts to rename a file, replacing the destination file if it already exists. */
+cc_result File_Rename(const cc_filepath* src, const cc_filepath* dst);
+/* Attempts to delete the given file. */
+cc_result File_Delete(const cc_filepath* path);
+/* Attempts to map the entire contents of the given file into memory as readonly data. */
+/* NOTE: The mapped data remains valid after the file is closed, until File_Unmap is called. */
+/* NOTE: On platforms without memory mapped files, the file is read into allocated memory instead. */
+cc_result File_Map(cc_file file, void** data, cc_uint32* size);
+/* Unmaps data previously mapped by File_Map. */
+void File_Unmap(void* data, cc_uint32 size);
 
 
 /*########################################################################################################################*
@@ -318,6 +328,9 @@ CC_API void Thread_Detach(void* handle);
 /* Blocks the current thread, until the given thread has finished. */
 /* NOTE: This cannot be used on a thread that has been detached. */
 CC_API void Thread_Join(void* handle);
+/* Returns the number of processors that threads can run on at the same time. */
+/* NOTE: Returns 1 on platforms where this isn't known. */
+int Thread_ProcessorCount(void);
 
 
 /*########################################################################################################################*
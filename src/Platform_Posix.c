@@ -2,6 +2,10 @@
 #if defined CC_BUILD_POSIX
 
 #define CC_XTEA_ENCRYPTION
+#define OVERRIDE_FILE_RENAME
+#define OVERRIDE_FILE_DELETE
+#define OVERRIDE_FILE_MAP
+#define OVERRIDE_THREAD_PROCESSORCOUNT
 #include "Stream.h"
 #include "ExtMath.h"
 #include "SystemFonts.h"
@@ -29,6 +33,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <netdb.h>
 
 const cc_result ReturnCode_FileShareViolation = 1000000000; /* TODO: not used apparently */
@@ -428,6 +433,30 @@ cc_result File_Length(cc_file file, cc_uint32* len) {
 	*len = st.st_size; return 0;
 }
 
+cc_result File_Rename(const cc_filepath* src, const cc_filepath* dst) {
+	return rename(src->buffer, dst->buffer) == -1 ? errno : 0;
+}
+
+cc_result File_Delete(const cc_filepath* path) {
+	return unlink(path->buffer) == -1 ? errno : 0;
+}
+
+cc_result File_Map(cc_file file, void** data, cc_uint32* size) {
+	struct stat st;
+	void* ptr;
+	if (fstat(file, &st) == -1) return errno;
+
+	/* Shared mapping, so multiple processes mapping the same file can share its pages */
+	ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, file, 0);
+	if (ptr == MAP_FAILED) return errno;
+
+	*data = ptr;
+	*size = st.st_size;
+	return 0;
+}
+
+void File_Unmap(void* data, cc_uint32 size) { munmap(data, size); }
+
 
 /*########################################################################################################################*
 *--------------------------------------------------------Threading--------------------------------------------------------*
@@ -488,6 +517,15 @@ void Thread_Join(void* handle) {
 	Mem_Free(ptr);
 }
 
+int Thread_ProcessorCount(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#else
+	return 1;
+#endif
+}
+
 void* Mutex_Create(const char* name) {
 	pthread_mutex_t* ptr = (pthread_mutex_t*)Mem_Alloc(1, sizeof(pthread_mutex_t), "mutex");
 	int res = pthread_mutex_init(ptr, NULL);
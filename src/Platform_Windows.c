@@ -8,6 +8,10 @@
 #include "Utils.h"
 #include "Errors.h"
 #define OVERRIDE_MEM_FUNCTIONS
+#define OVERRIDE_FILE_RENAME
+#define OVERRIDE_FILE_DELETE
+#define OVERRIDE_FILE_MAP
+#define OVERRIDE_THREAD_PROCESSORCOUNT
 
 #define WIN32_LEAN_AND_MEAN
 #define NOSERVICE
@@ -421,6 +425,42 @@ cc_result File_Length(cc_file file, cc_uint32* len) {
 	return *len != INVALID_FILE_SIZE ? 0 : GetLastError();
 }
 
+cc_result File_Rename(const cc_filepath* src, const cc_filepath* dst) {
+	cc_result res;
+	if (MoveFileExW(src->uni, dst->uni, MOVEFILE_REPLACE_EXISTING)) return 0;
+	if ((res = GetLastError()) != ERROR_CALL_NOT_IMPLEMENTED) return res;
+
+	/* Windows 9x does not support W API functions, or replacing files when moving */
+	DeleteFileA(dst->ansi);
+	return MoveFileA(src->ansi, dst->ansi) ? 0 : GetLastError();
+}
+
+cc_result File_Delete(const cc_filepath* path) {
+	cc_result res;
+	if (DeleteFileW(path->uni)) return 0;
+	if ((res = GetLastError()) != ERROR_CALL_NOT_IMPLEMENTED) return res;
+
+	return DeleteFileA(path->ansi) ? 0 : GetLastError();
+}
+
+cc_result File_Map(cc_file file, void** data, cc_uint32* size) {
+	HANDLE mapping;
+	cc_result res;
+	if ((res = File_Length(file, size))) return res;
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping) return GetLastError();
+
+	*data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	res   = *data ? 0 : GetLastError();
+
+	/* The view keeps the underlying file mapping alive */
+	CloseHandle(mapping);
+	return res;
+}
+
+void File_Unmap(void* data, cc_uint32 size) { UnmapViewOfFile(data); }
+
 
 /*########################################################################################################################*
 *--------------------------------------------------------Threading--------------------------------------------------------*
@@ -458,6 +498,12 @@ void Thread_Join(void* handle) {
 #endif
 }
 
+int Thread_ProcessorCount(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return max(1, (int)info.dwNumberOfProcessors);
+}
+
 
 /*########################################################################################################################*
 *-----------------------------------------------------Synchronisation-----------------------------------------------------*
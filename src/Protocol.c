@@ -41,6 +41,12 @@ struct _ProtocolData Protocol;
 /* Classic state */
 static cc_bool classic_receivedFirstPos;
 
+/* Position update state */
+struct PositionState { int x, y, z; cc_uint8 yaw, pitch; BlockID held; };
+static struct PositionState pos_last;
+static int pos_ticks;
+static cc_bool pos_resync;
+
 /* Map state */
 static cc_bool map_begunLoading;
 static cc_uint64 map_receiveBeg;
@@ -235,6 +241,8 @@ static void AddEntity(cc_uint8* data, EntityID id, const cc_string* name, const
 
 static void UpdateLocation(EntityID id, struct LocationUpdate* update) {
 	struct Entity* e = Entities.List[id];
+	/* Server moved the player, so always send the next position update */
+	if (id == ENTITIES_SELF_ID) pos_resync = true;
 	if (e) { e->VTABLE->SetLocation(e, update); }
 }
 
@@ -351,7 +359,6 @@ static void WoM_Tick(void) {
 
 struct MapState {
 	struct InflateState inflateState;
-	struct Stream stream;
 	BlockRaw* blocks;
 	struct GZipHeader gzHeader;
 	cc_uint8 size[MAP_SIZE_LEN];
@@ -373,7 +380,7 @@ static void DisconnectInvalidMap(cc_result res) {
 }
 
 static void MapState_Init(struct MapState* m) {
-	Inflate_MakeStream2(&m->stream, &m->inflateState, &map_part);
+	Inflate_Init2(&m->inflateState, NULL);
 	GZipHeader_Init(&m->gzHeader);
 
 	m->index       = 0;
@@ -396,14 +403,19 @@ static void FreeMapStates(void) {
 #endif
 }
 
-static cc_result MapState_Read(struct MapState* m) {
+/* Decompresses the given map data directly into the blocks array */
+/* NOTE: The compressed data is read straight from the network read buffer, */
+/*  avoiding the overhead of first copying it into the inflater's input buffer */
+static cc_result MapState_Read(struct MapState* m, cc_uint8* data, cc_uint32 len) {
+	struct InflateState* inflate = &m->inflateState;
 	cc_uint32 left, read;
 	cc_result res;
 	if (m->allocFailed) return 0;
+	Inflate_SetInput(inflate, data, len);
 
 	if (m->sizeIndex < MAP_SIZE_LEN) {
 		left = MAP_SIZE_LEN - m->sizeIndex;
-		res  = m->stream.Read(&m->stream, &m->size[m->sizeIndex], left, &read); 
+		res  = Inflate_Decompress(inflate, &m->size[m->sizeIndex], left, &read);
 
 		m->sizeIndex += read;
 		if (res) return res;
@@ -425,9 +437,11 @@ static cc_result MapState_Read(struct MapState* m) {
 	}
 
 	left = map_volume - m->index;
-	res  = m->stream.Read(&m->stream, &m->blocks[m->index], left, &read);
-
+	res  = Inflate_Decompress(inflate, &m->blocks[m->index], left, &read);
 	m->index += read;
+
+	/* Any leftover input is just the GZIP footer, so can be ignored */
+	Inflate_SetInput(inflate, NULL, 0);
 	return res;
 }
 
@@ -459,30 +473,32 @@ void Classic_BuildChat(const cc_string* text, cc_bool partial, struct ChatPacket
 	WriteString(pkt->msg, text);
 }
 
-static cc_uint8* Classic_WritePosition(cc_uint8* data, Vec3 pos, float yaw, float pitch) {
-	BlockID payload;
-	int x, y, z;
+static void Classic_MakePosition(struct PositionState* state, Vec3 pos, float yaw, float pitch) {
+	state->held  = IsSupported(heldBlock_Ext) ? Inventory_SelectedBlock : ENTITIES_SELF_ID;
+	state->x     = (int)(pos.x * 32);
+	state->y     = (int)(pos.y * 32) + 51;
+	state->z     = (int)(pos.z * 32);
+	state->yaw   = Math_Deg2Packed(yaw);
+	state->pitch = Math_Deg2Packed(pitch);
+}
 
+static cc_uint8* Classic_WritePosition(cc_uint8* data, const struct PositionState* state) {
 	*data++ = OPCODE_ENTITY_TELEPORT;
 	{
-		payload = IsSupported(heldBlock_Ext) ? Inventory_SelectedBlock : ENTITIES_SELF_ID;
-		WriteBlock(data, payload);
-		x = (int)(pos.x * 32);
-		y = (int)(pos.y * 32) + 51;
-		z = (int)(pos.z * 32);
+		WriteBlock(data, state->held);
 
 		if (IsSupported(extEntityPos_Ext)) {
-			Mem_WriteU32_BE(data, x); data += 4;
-			Mem_WriteU32_BE(data, y); data += 4;
-			Mem_WriteU32_BE(data, z); data += 4;
+			Mem_WriteU32_BE(data, state->x); data += 4;
+			Mem_WriteU32_BE(data, state->y); data += 4;
+			Mem_WriteU32_BE(data, state->z); data += 4;
 		} else {
-			Mem_WriteU16_BE(data, x); data += 2;
-			Mem_WriteU16_BE(data, y); data += 2;
-			Mem_WriteU16_BE(data, z); data += 2;
+			Mem_WriteU16_BE(data, state->x); data += 2;
+			Mem_WriteU16_BE(data, state->y); data += 2;
+			Mem_WriteU16_BE(data, state->z); data += 2;
 		}
 
-		*data++ = Math_Deg2Packed(yaw);
-		*data++ = Math_Deg2Packed(pitch);
+		*data++ = state->yaw;
+		*data++ = state->pitch;
 	}
 	return data;
 }
@@ -586,7 +602,7 @@ static void Classic_LevelDataChunk(cc_uint8* data) {
 	}
 
 	if (m->gzHeader.done) {
-		res = MapState_Read(m);
+		res = MapState_Read(m, map_part.meta.mem.cur, map_part.meta.mem.left);
 		if (res) { DisconnectInvalidMap(res); return; }
 	}
 
@@ -801,6 +817,8 @@ static void Classic_Reset(void) {
 	Stream_ReadonlyMemory(&map_part, NULL, 0);
 	map_begunLoading = false;
 	classic_receivedFirstPos = false;
+	pos_ticks  = 0;
+	pos_resync = true;
 
 	Net_Set(OPCODE_HANDSHAKE, Classic_Handshake, Classic_HandshakeSize());
 	Net_Set(OPCODE_PING, Classic_Ping, 1);
@@ -821,13 +839,33 @@ static void Classic_Reset(void) {
 	Net_Set(OPCODE_SET_PERMISSION, Classic_SetPermission, 2);
 }
 
+/* Position is still sent at least once a second, even when not moving */
+#define POS_IDLE_TICKS 20
+
+/* Whether the position update would differ from the last one sent, or the last one was too long ago */
+static cc_bool Classic_ShouldSendPosition(const struct PositionState* state) {
+	if (pos_resync || pos_ticks >= POS_IDLE_TICKS) return true;
+
+	return state->x   != pos_last.x   || state->y     != pos_last.y     || state->z != pos_last.z
+		|| state->yaw != pos_last.yaw || state->pitch != pos_last.pitch || state->held != pos_last.held;
+}
+
 static cc_uint8* Classic_Tick(cc_uint8* data) {
 	struct Entity* e = &Entities.CurPlayer->Base;
+	struct PositionState state;
 	if (!classic_receivedFirstPos) return data;
 
 	/* Report end position of each physics tick, rather than current position */
 	/*  (otherwise can miss landing on a block then jumping off of it again) */
-	return Classic_WritePosition(data, e->next.pos, e->Yaw, e->Pitch);
+	Classic_MakePosition(&state, e->next.pos, e->Yaw, e->Pitch);
+	pos_ticks++;
+	if (!Classic_ShouldSendPosition(&state)) return data;
+
+	data = Classic_WritePosition(data, &state);
+	pos_last   = state;
+	pos_ticks  = 0;
+	pos_resync = false;
+	return data;
 }
 
 
@@ -1961,10 +1999,14 @@ static void Protocol_Reset(void) {
 
 void Protocol_Tick(void) {
 	cc_uint8 tmp[256];
-	cc_uint8* data = tmp;
+	cc_uint8* data;
+
+	/* Position update is sent separately, so that it can replace the previous */
+	/*  position update when outgoing data is backed up due to a slow connection */
+	data = Classic_Tick(tmp);
+	if (data != tmp) Server_SendPosition(tmp, (cc_uint32)(data - tmp));
 
-	data = Classic_Tick(data);
-	data = CPE_Tick(data);
+	data = CPE_Tick(tmp);
 	WoM_Tick();
 
 	/* Have any packets been written? */
@@ -3,6 +3,7 @@
 
 #if CC_SSL_BACKEND == CC_SSL_BACKEND_BEARSSL
 #include "String_.h"
+#include "Constants.h"
 #include "Certs.h"
 #include "../third_party/bearssl/bearssl.h"
 #include "../misc/certs/certs.h"
@@ -18,8 +19,130 @@ typedef struct SSLContext {
 	br_sslio_context ioc;
 	cc_result readError, writeError;
 	cc_socket socket;
+	cc_uint64 handshakeStart;
+	cc_bool handshakeDone;
+	br_ssl_session_parameters resumed; /* Parameters of session attempting to resume (if any) */
+	cc_string host;
+	char _hostBuffer[STRING_SIZE];
 } SSLContext;
 static cc_bool _verifyCerts;
+/* System certificate verification isn't necessarily thread safe */
+static void* certsMutex;
+
+/*########################################################################################################################*
+*------------------------------------------------------Session cache------------------------------------------------------*
+*#########################################################################################################################*/
+/* Parameters of previously established sessions, which are resumed for new connections to the same host */
+/*  to avoid the cost of performing a full handshake again */
+/* NOTE: BearSSL only supports resumption using session IDs (not session tickets) */
+#define SSL_MAX_SESSIONS 8
+static struct SSLSession {
+	cc_string host;
+	char _hostBuffer[STRING_SIZE];
+	br_ssl_session_parameters params;
+	cc_uint64 lastUsed;
+} ssl_sessions[SSL_MAX_SESSIONS];
+
+static void* sessionsMutex;
+static int ssl_numFull, ssl_numResumed;
+static int ssl_fullTime, ssl_resumedTime;
+
+/* NOTE: Must be called while holding sessionsMutex */
+static struct SSLSession* SSLSession_Find(const cc_string* host) {
+	int i;
+	for (i = 0; i < SSL_MAX_SESSIONS; i++)
+	{
+		if (!ssl_sessions[i].host.length) continue;
+		if (String_CaselessEquals(&ssl_sessions[i].host, host)) return &ssl_sessions[i];
+	}
+	return NULL;
+}
+
+/* Retrieves the parameters of the previous session with the given host (if any) */
+static cc_bool SSLSession_Get(const cc_string* host, br_ssl_session_parameters* params) {
+	struct SSLSession* session;
+
+	Mutex_Lock(sessionsMutex);
+	{
+		session = SSLSession_Find(host);
+		if (session) *params = session->params;
+	}
+	Mutex_Unlock(sessionsMutex);
+	return session != NULL;
+}
+
+/* NOTE: Must be called while holding sessionsMutex */
+static struct SSLSession* SSLSession_FindOldest(void) {
+	struct SSLSession* oldest = &ssl_sessions[0];
+	int i;
+
+	for (i = 1; i < SSL_MAX_SESSIONS; i++)
+	{
+		if (ssl_sessions[i].lastUsed < oldest->lastUsed) oldest = &ssl_sessions[i];
+	}
+	return oldest;
+}
+
+static void SSLSession_Save(const cc_string* host, const br_ssl_session_parameters* params) {
+	struct SSLSession* session;
+	/* Server doesn't support resuming sessions */
+	if (!params->session_id_len || !host->length) return;
+
+	Mutex_Lock(sessionsMutex);
+	{
+		session = SSLSession_Find(host);
+		if (!session) session = SSLSession_FindOldest();
+		
+		String_InitArray(session->host, session->_hostBuffer);
+		String_Copy(&session->host, host);
+		session->params   = *params;
+		session->lastUsed = Stopwatch_Measure();
+	}
+	Mutex_Unlock(sessionsMutex);
+}
+
+static void SSLSession_Remove(const cc_string* host) {
+	struct SSLSession* session;
+
+	Mutex_Lock(sessionsMutex);
+	{
+		session = SSLSession_Find(host);
+		if (session) { session->host.length = 0; session->lastUsed = 0; }
+	}
+	Mutex_Unlock(sessionsMutex);
+}
+
+/* Updates session cache and handshake statistics after a handshake has completed */
+static void SSLSession_Finish(SSLContext* ctx) {
+	br_ssl_session_parameters params;
+	int elapsed, count, total;
+	cc_bool resumed = false;
+	ctx->handshakeDone = true;
+
+	br_ssl_engine_get_session_parameters(&ctx->sc.eng, &params);
+	/* Server accepted resuming the session if it echoed back the same session ID */
+	if (ctx->resumed.session_id_len && params.session_id_len == ctx->resumed.session_id_len) {
+		resumed = Mem_Equal(params.session_id, ctx->resumed.session_id, params.session_id_len);
+	}
+
+	elapsed = Stopwatch_ElapsedMS(ctx->handshakeStart, Stopwatch_Measure());
+	Mutex_Lock(sessionsMutex);
+	{
+		if (resumed) {
+			ssl_numResumed++; ssl_resumedTime += elapsed;
+			count = ssl_numResumed; total = ssl_resumedTime;
+		} else {
+			ssl_numFull++; ssl_fullTime += elapsed;
+			count = ssl_numFull; total = ssl_fullTime;
+		}
+	}
+	Mutex_Unlock(sessionsMutex);
+
+	Platform_Log4("SSL: %c handshake in %i ms (%i in %i ms total)", 
+				resumed ? "Resumed" : "Full", &elapsed, &count, &total);
+	SSLSession_Save(&ctx->host, &params);
+}
+
 
 static void x509_start_cert(const br_x509_class** ctx, uint32_t length) {
 	struct SSLContext* ssl = (struct SSLContext*)ctx;
@@ -62,7 +185,11 @@ static unsigned x509_maybe_system_verify(struct SSLContext* ssl, unsigned r) {
 	if (r != BR_ERR_X509_NOT_TRUSTED) return r;
 	if (!ssl->x509.numCerts)          return r;
 
-	if (Certs_VerifyChain(&ssl->x509) == 0) r = 0;
+	Mutex_Lock(certsMutex);
+	{
+		if (Certs_VerifyChain(&ssl->x509) == 0) r = 0;
+	}
+	Mutex_Unlock(certsMutex);
 	return r;
 }
 
@@ -93,6 +220,8 @@ static const br_x509_class cert_verifier_vtable = {
 
 void SSLBackend_Init(cc_bool verifyCerts) {
 	_verifyCerts = verifyCerts;
+	certsMutex    = Mutex_Create("SSL certs");
+	sessionsMutex = Mutex_Create("SSL sessions");
 	CertsBackend_Init();
 }
 
@@ -189,7 +318,17 @@ cc_result SSL_Init(cc_socket socket, const cc_string* host_, void** out_ctx) {
 	ctx->socket = socket;
 
 	br_ssl_engine_set_buffer(&ctx->sc.eng, ctx->iobuf, sizeof(ctx->iobuf), 1);
-	br_ssl_client_reset(&ctx->sc, host, 0);
+	String_InitArray(ctx->host, ctx->_hostBuffer);
+	/* Very long hosts are uncommon, so just don't cache their sessions */
+	if (host_->length < STRING_SIZE) String_Copy(&ctx->host, host_);
+
+	ctx->resumed.session_id_len = 0;
+	if (ctx->host.length && SSLSession_Get(&ctx->host, &ctx->resumed)) {
+		br_ssl_engine_set_session_parameters(&ctx->sc.eng, &ctx->resumed);
+		br_ssl_client_reset(&ctx->sc, host, 1);
+	} else {
+		br_ssl_client_reset(&ctx->sc, host, 0);
+	}
 	ctx->xc.vtable = &cert_verifier_vtable;
 	
 	/* Account login must be done over TLS 1.2 */
@@ -203,10 +342,21 @@ cc_result SSL_Init(cc_socket socket, const cc_string* host_, void** out_ctx) {
 			
 	ctx->readError  = 0;
 	ctx->writeError = 0;
+	/* Handshake is performed when data is first written/read */
+	ctx->handshakeDone  = false;
+	ctx->handshakeStart = Stopwatch_Measure();
 	
 	return 0;
 }
 
+static void SSL_CheckHandshake(SSLContext* ctx) {
+	unsigned state;
+	if (ctx->handshakeDone) return;
+
+	state = br_ssl_engine_current_state(&ctx->sc.eng);
+	if (state & (BR_SSL_SENDAPP | BR_SSL_RECVAPP)) SSLSession_Finish(ctx);
+}
+
 static CC_NOINLINE cc_result SSL_GetError(SSLContext* ctx) {
 	int err;
 	if (ctx->writeError) return ctx->writeError;
@@ -225,6 +375,7 @@ cc_result SSL_Read(void* ctx_, cc_uint8* data, cc_uint32 count, cc_uint32* read)
 	int res = br_sslio_read(&ctx->ioc, data, count);
 	if (res < 0) return SSL_GetError(ctx);	
 	
+	SSL_CheckHandshake(ctx);
 	*read = res;
 	return 0;
 }
@@ -235,12 +386,17 @@ cc_result SSL_Write(void* ctx_, const cc_uint8* data, cc_uint32 count, cc_uint32
 	if (res < 0) return SSL_GetError(ctx);
 	
 	br_sslio_flush(&ctx->ioc);
+	SSL_CheckHandshake(ctx);
 	*sent = res;
 	return 0;
 }
 
 cc_result SSL_Free(void* ctx_) {
 	SSLContext* ctx = (SSLContext*)ctx_;
+	/* Server may no longer accept the session, so don't try to resume it again */
+	if (ctx && !ctx->handshakeDone && ctx->resumed.session_id_len) {
+		SSLSession_Remove(&ctx->host);
+	}
 	if (ctx) br_sslio_close(&ctx->ioc);
 	
 	Mem_Free(ctx_);
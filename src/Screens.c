@@ -444,6 +444,14 @@ void HUDScreen_Show(void) {
 #define TABLIST_MAX_ENTRIES (TABLIST_MAX_NAMES * 2)
 typedef int (*TabListEntryCompare)(int x, int y);
 
+/* Group header textures are kept when re-sorting, so they aren't redrawn every time a player is added/updated */
+struct TabListGroupHeader {
+	struct Texture tex;
+	cc_bool used;
+	cc_uint8 nameLength;
+	char name[STRING_SIZE];
+};
+
 static struct TabListOverlay {
 	Screen_Body
 	int x, y, width, height;
@@ -454,6 +462,9 @@ static struct TabListOverlay {
 	TabListEntryCompare compare;
 	cc_uint16 ids[TABLIST_MAX_ENTRIES];
 	struct Texture textures[TABLIST_MAX_ENTRIES];
+	/* NOTE: Entries with GROUP_NAME_ID don't own their texture, it is owned by the group header */
+	int headersCount;
+	struct TabListGroupHeader headers[TABLIST_MAX_NAMES];
 } TabListOverlay_Instance CC_BIG_VAR;
 #define TABLIST_MAX_VERTICES (TEXTWIDGET_MAX + 4 * TABLIST_MAX_ENTRIES)
 
@@ -570,7 +581,7 @@ static void TabListOverlay_AddName(struct TabListOverlay* s, EntityID id, int in
 }
 
 static void TabListOverlay_DeleteAt(struct TabListOverlay* s, int i) {
-	Gfx_DeleteTexture(&s->textures[i].ID);
+	if (s->ids[i] != GROUP_NAME_ID) Gfx_DeleteTexture(&s->textures[i].ID);
 
 	for (; i < s->usedCount - 1; i++)
 	{
@@ -583,6 +594,51 @@ static void TabListOverlay_DeleteAt(struct TabListOverlay* s, int i) {
 	s->textures[s->usedCount].ID = 0;
 }
 
+/* Deletes the textures of group headers which are no longer shown */
+static void TabListOverlay_DeleteUnusedHeaders(struct TabListOverlay* s) {
+	int i;
+	for (i = s->headersCount - 1; i >= 0; i--)
+	{
+		if (s->headers[i].used) continue;
+
+		Gfx_DeleteTexture(&s->headers[i].tex.ID);
+		s->headers[i] = s->headers[--s->headersCount];
+	}
+}
+
+/* Returns the texture of the header for the given group, only drawing it if it isn't already drawn */
+static struct Texture TabListOverlay_GetHeader(struct TabListOverlay* s, const cc_string* group) {
+	struct TabListGroupHeader* h;
+	int i;
+
+	for (i = 0; i < s->headersCount; i++)
+	{
+		h = &s->headers[i];
+		if (h->nameLength != group->length || !Mem_Equal(h->name, group->buffer, group->length)) continue;
+
+		h->used = true;
+		return h->tex;
+	}
+
+	/* Always succeeds in freeing space, as there can't be more groups shown than players */
+	if (s->headersCount == Array_Elems(s->headers)) TabListOverlay_DeleteUnusedHeaders(s);
+	h = &s->headers[s->headersCount++];
+	h->used       = true;
+	h->nameLength = min(group->length, STRING_SIZE);
+	Mem_Copy(h->name, group->buffer, h->nameLength);
+	TabListOverlay_DrawText(&h->tex, s, group);
+	return h->tex;
+}
+
+static void TabListOverlay_DeleteHeaders(struct TabListOverlay* s) {
+	int i;
+	for (i = 0; i < s->headersCount; i++) 
+	{
+		Gfx_DeleteTexture(&s->headers[i].tex.ID);
+	}
+	s->headersCount = 0;
+}
+
 static void TabListOverlay_AddGroup(struct TabListOverlay* s, int id, int* index) {
 	cc_string group;
 	int i;
@@ -594,9 +650,8 @@ static void TabListOverlay_AddGroup(struct TabListOverlay* s, int id, int* index
 		s->textures[i] = s->textures[i - 1];
 	}
 	
-	s->ids[*index] = GROUP_NAME_ID;
-	s->textures[*index].ID = 0; /* TODO: TEMP HACK! */
-	TabListOverlay_DrawText(&s->textures[*index], s, &group);
+	s->ids[*index]      = GROUP_NAME_ID;
+	s->textures[*index] = TabListOverlay_GetHeader(s, &group);
 
 	(*index)++;
 	s->usedCount++;
@@ -681,6 +736,8 @@ static void TabListOverlay_SortEntries(struct TabListOverlay* s) {
 		if (s->ids[i] != GROUP_NAME_ID) continue;
 		TabListOverlay_DeleteAt(s, i);
 	}
+	for (i = 0; i < s->headersCount; i++) { s->headers[i].used = false; }
+
 	TabListOverlay_Instance.compare = TabListOverlay_GroupCompare;
 	TabListOverlay_QuickSort(0, s->usedCount - 1);
 
@@ -695,6 +752,7 @@ static void TabListOverlay_SortEntries(struct TabListOverlay* s) {
 		TabListOverlay_QuickSort(i, i + (count - 1));
 		i += count;
 	}
+	TabListOverlay_DeleteUnusedHeaders(s);
 }
 
 static void TabListOverlay_SortAndLayout(struct TabListOverlay* s) {
@@ -771,8 +829,10 @@ static void TabListOverlay_ContextLost(void* screen) {
 	int i;
 	for (i = 0; i < s->usedCount; i++)
 	{
+		if (s->ids[i] == GROUP_NAME_ID) continue;
 		Gfx_DeleteTexture(&s->textures[i].ID);
 	}
+	TabListOverlay_DeleteHeaders(s);
 
 	Elem_Free(&s->title);
 	Font_Free(&s->font);
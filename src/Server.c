@@ -242,6 +242,29 @@ static float timeSinceLast;
 static cc_bool net_connecting;
 #define NET_TIMEOUT_SECS 15
 
+/* Outgoing data that couldn't be immediately sent (e.g. socket send buffer full) */
+/* Unsent data lies between net_writeHead and net_writeTail */
+#define NET_WRITE_BUFFER_SIZE (4096 * 4)
+static cc_uint8 net_writeBuffer[NET_WRITE_BUFFER_SIZE];
+static cc_uint32 net_writeHead, net_writeTail;
+/* Offset of still entirely unsent position update at end of queue, -1 if none */
+static int net_writePosOffset = -1;
+/* Time any queued outgoing data was last accepted by the socket */
+static cc_uint64 net_writeLastSent;
+
+static struct NetSendStats {
+	cc_uint32 peakQueued, coalesced;
+	cc_uint64 stallBeg;
+} net_sendStats;
+
+static void MPConnection_ResetWrites(void) {
+	net_writeHead = 0;
+	net_writeTail = 0;
+	net_writePosOffset = -1;
+	net_writeLastSent  = 0;
+	Mem_Set(&net_sendStats, 0, sizeof(net_sendStats));
+}
+
 static void MPConnection_FinishConnect(void) {
 	net_connecting = false;
 	timeSinceLast  = 0.0f;
@@ -405,6 +428,154 @@ static void DisconnectInvalidOpcode(cc_uint8 opcode) {
 	Game_Disconnect(&title, &tmp); return;
 }
 
+static void MPConnection_LogStall(void) {
+	int elapsedMS = Stopwatch_ElapsedMS(net_sendStats.stallBeg, Stopwatch_Measure());
+	int peak = net_sendStats.peakQueued, coalesced = net_sendStats.coalesced;
+
+	Platform_Log3("Send queue drained after %i ms (peak %i bytes, %i position updates coalesced)",
+					&elapsedMS, &peak, &coalesced);
+	net_sendStats.peakQueued = 0;
+	net_sendStats.coalesced  = 0;
+}
+
+/* Tries to send as much queued outgoing data as the socket will currently accept */
+static void MPConnection_FlushWrites(void) {
+	cc_uint32 wrote;
+	cc_result res;
+
+	while (net_writeHead < net_writeTail) {
+		res = Socket_Write(net_socket, net_writeBuffer + net_writeHead, net_writeTail - net_writeHead, &wrote);
+		/* Send buffer still full, try again later */
+		if (res == ReturnCode_SocketInProgess || res == ReturnCode_SocketWouldBlock) break;
+
+		/* NOTE: Not immediately disconnecting here, as otherwise we sometimes miss out on kick messages */
+		if (res)    { net_writeFailure = res;                  return; }
+		if (!wrote) { net_writeFailure = ERR_INVALID_ARGUMENT; return; }
+		net_writeHead    += wrote;
+		net_writeLastSent = Stopwatch_Measure();
+	}
+
+	/* Position update may have been partially sent, so can no longer be replaced */
+	if (net_writePosOffset >= 0 && net_writeHead > (cc_uint32)net_writePosOffset) net_writePosOffset = -1;
+	if (net_writeHead < net_writeTail) return;
+
+	if (net_sendStats.stallBeg) MPConnection_LogStall();
+	net_sendStats.stallBeg = 0;
+	net_writeHead = 0;
+	net_writeTail = 0;
+}
+
+static void MPConnection_TickWrites(void) {
+	cc_bool writable;
+	cc_result res;
+	if (net_writeHead == net_writeTail) return;
+
+	res = Socket_Poll(net_socket, 0, SOCKET_POLL_WRITE, &writable);
+	if (res) { net_writeFailure = res; return; }
+	if (writable) MPConnection_FlushWrites();
+	if (net_writeHead == net_writeTail || net_writeFailure) return;
+
+	/* Server hasn't accepted any data in a long time, so give up on the connection */
+	if (Stopwatch_ElapsedMS(net_writeLastSent, Stopwatch_Measure()) >= NET_TIMEOUT_SECS * 1000) {
+		net_writeFailure = ReturnCode_SocketWouldBlock;
+	}
+}
+
+/* Returns whether the outgoing data queue has room for at least the given number of bytes */
+/* NOTE: Never waits for the socket, as this is called from the game's main thread */
+static cc_bool MPConnection_MakeRoom(cc_uint32 len) {
+	cc_uint32 queued;
+	/* Send whatever the socket will currently accept without blocking */
+	MPConnection_FlushWrites();
+	if (net_writeFailure) return false;
+	queued = net_writeTail - net_writeHead;
+
+	/* Not enough room at end of buffer, so shift unsent data back to start */
+	if (net_writeTail + len > NET_WRITE_BUFFER_SIZE && net_writeHead) {
+		Mem_Move(net_writeBuffer, net_writeBuffer + net_writeHead, queued);
+		if (net_writePosOffset >= 0) net_writePosOffset -= net_writeHead;
+
+		net_writeHead = 0;
+		net_writeTail = queued;
+	}
+	return net_writeTail + len <= NET_WRITE_BUFFER_SIZE;
+}
+
+/* Appends data to the end of the outgoing data queue */
+/* If the queue is full, the server isn't keeping up at all, so the connection is given up on */
+static void MPConnection_QueueWrite(const cc_uint8* data, cc_uint32 len) {
+	cc_uint32 queued;
+	if (net_writeHead == net_writeTail) net_writeLastSent = Stopwatch_Measure();
+
+	if (!MPConnection_MakeRoom(len)) {
+		if (!net_writeFailure) net_writeFailure = ReturnCode_SocketWouldBlock;
+		return;
+	}
+
+	if (!net_sendStats.stallBeg) net_sendStats.stallBeg = Stopwatch_Measure();
+	queued = net_writeTail - net_writeHead;
+
+	Mem_Copy(net_writeBuffer + net_writeTail, data, len);
+	net_writeTail += len;
+	net_writePosOffset = -1;
+
+	queued += len;
+	net_sendStats.peakQueued = max(net_sendStats.peakQueued, queued);
+}
+
+static void MPConnection_SendData(const cc_uint8* data, cc_uint32 len) {
+	cc_uint32 wrote;
+	cc_result res;
+	if (Server.Disconnected || net_writeFailure) return;
+
+	/* Data must be sent in order, so append to end of any already queued data */
+	if (net_writeHead < net_writeTail) {
+		MPConnection_QueueWrite(data, len); return;
+	}
+
+	while (len) {
+		res = Socket_Write(net_socket, data, len, &wrote);
+		/* If sending would block (send buffer full), queue remaining data to send later */
+		/*  instead of blocking the game until the server catches up */
+		if (res == ReturnCode_SocketInProgess || res == ReturnCode_SocketWouldBlock) {
+			MPConnection_QueueWrite(data, len); return;
+		}
+
+		/* NOTE: Not immediately disconnecting here, as otherwise we sometimes miss out on kick messages */
+		if (res)    { net_writeFailure = res;                  return; }
+		if (!wrote) { net_writeFailure = ERR_INVALID_ARGUMENT; return; }
+
+		data += wrote; len -= wrote;
+	}
+}
+
+void Server_SendPosition(const cc_uint8* data, cc_uint32 len) {
+	cc_bool wasQueued;
+	if (Server.Disconnected || net_writeFailure) return;
+
+	/* Previous position update is still queued and unsent, and nothing */
+	/*  has been queued since - so just overwrite it with the new position */
+	if (net_writePosOffset >= 0 && net_writeTail - net_writePosOffset == len) {
+		Mem_Copy(net_writeBuffer + net_writePosOffset, data, len);
+		net_sendStats.coalesced++;
+		return;
+	}
+
+	wasQueued = net_writeHead < net_writeTail;
+	/* Position updates are superseded by the next one anyway, so drop rather than disconnect when the queue is full */
+	if (wasQueued && !MPConnection_MakeRoom(len)) {
+		if (!net_writeFailure) net_sendStats.coalesced++;
+		return;
+	}
+
+	wasQueued = net_writeHead < net_writeTail;
+	MPConnection_SendData(data, len);
+	if (net_writeFailure) return;
+
+	/* Check if entire position update ended up being queued */
+	if (wasQueued || net_writeTail - net_writeHead == len) net_writePosOffset = net_writeTail - len;
+}
+
 static cc_bool MPConnection_Tick(struct ScheduledTask2* task) {
 	Net_Handler handler;
 	cc_uint8* readEnd;
@@ -467,6 +638,7 @@ static cc_bool MPConnection_Tick(struct ScheduledTask2* task) {
 		net_readCurrent = net_readBuffer + remaining;
 	}
 
+	MPConnection_TickWrites();
 	if (net_writeFailure) {
 		Platform_Log1("Error from send: %e", &net_writeFailure);
 		MPConnection_Disconnect(); return true;
@@ -480,30 +652,6 @@ static cc_bool MPConnection_Tick(struct ScheduledTask2* task) {
 	return true;
 }
 
-static void MPConnection_SendData(const cc_uint8* data, cc_uint32 len) {
-	cc_uint32 wrote;
-	cc_result res;
-	int tries = 0;
-	if (Server.Disconnected) return;
-
-	while (len) {
-		res = Socket_Write(net_socket, data, len, &wrote);
-		/* If sending would block (send buffer full), retry for a bit up to 10 seconds */
-		/* TODO: Avoid doing this and manually buffer data when this happens */
-		if (res && tries < 1000 && (res == ReturnCode_SocketInProgess || res == ReturnCode_SocketWouldBlock)) {
-			Thread_Sleep(10);
-			tries++;
-			continue;
-		}
-
-		/* NOTE: Not immediately disconnecting here, as otherwise we sometimes miss out on kick messages */
-		if (res)    { net_writeFailure = res;                  return; }
-		if (!wrote) { net_writeFailure = ERR_INVALID_ARGUMENT; return; }
-
-		data += wrote; len -= wrote;
-	}
-}
-
 static void MPConnection_Init(void) {
 	Server_ResetState();
 	Server.IsSinglePlayer = false;
@@ -514,9 +662,12 @@ static void MPConnection_Init(void) {
 	Server.SendChat     = MPConnection_SendChat;
 	Server.SendData     = MPConnection_SendData;
 	net_readCurrent     = net_readBuffer;
+	MPConnection_ResetWrites();
 }
 #else
 static void MPConnection_Init(void) { SPConnection_Init(); }
+static void MPConnection_ResetWrites(void) { }
+void Server_SendPosition(const cc_uint8* data, cc_uint32 len) { }
 #endif
 
 
@@ -562,6 +713,7 @@ static void OnInit(void) {
 static void OnReset(void) {
 	if (Server.IsSinglePlayer) return;
 	net_writeFailure = 0;
+	MPConnection_ResetWrites();
 	OnClose();
 }
 
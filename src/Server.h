@@ -74,6 +74,10 @@ CC_VAR extern struct _ServerConnectionData {
 /* Otherwise just calls TexturePack_Extract */
 void Server_RetrieveTexturePack(const cc_string* url);
 
+/* Sends a position update packet to the server */
+/* NOTE: If outgoing data is backed up, replaces the previous still unsent position update */
+void Server_SendPosition(const cc_uint8* data, cc_uint32 len);
+
 /* Path of map to automatically load in singleplayer */
 extern cc_string SP_AutoloadMap;
 
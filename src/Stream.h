@@ -37,6 +37,7 @@ struct Stream {
 		struct { struct Stream* source; cc_uint32 left, length; } portion;
 		struct { cc_uint8* cur; cc_uint32 left, length; cc_uint8* base; struct Stream* source; cc_uint32 end; } buffered;
 		struct { struct Stream* source; cc_uint32 crc32; } crc32;
+		struct { struct Bitmap* bmp; cc_result result; } png;
 	} meta;
 };
 
@@ -522,6 +522,16 @@ cc_result TexturePack_ExtractDefault(DefaultZipCallback callback, const char** d
 }
 
 
+static struct TextureEntry* entries_head;
+static struct TextureEntry* entries_tail;
+
+void TextureEntry_Register(struct TextureEntry* entry) {
+	LinkedList_Append(entry, entries_head, entries_tail);
+}
+
+#if defined CC_BUILD_LOWMEM || defined CC_BUILD_COOPTHREADED
+static void ApplyPendingPngs(void) { }
+
 static cc_bool SelectZipEntry(const cc_string* path) { return true; }
 static cc_result ProcessZipEntry(const cc_string* path, struct Stream* stream, struct ZipEntry* source) {
 	cc_string name = *path;
@@ -529,6 +539,131 @@ static cc_result ProcessZipEntry(const cc_string* path, struct Stream* stream, s
 	Event_RaiseEntry(&TextureEvents.FileChanged, stream, &name);
 	return 0;
 }
+#else
+/* Texture pack .zip archives are applied in three stages: */
+/*  1) Entries are read from the archive on the main thread, with .png files used by texture entries kept in memory */
+/*  2) Those .png files are then decoded in parallel on worker threads */
+/*  3) Decoded images are then passed to texture entries (e.g. to upload to the GPU) on the main thread */
+#define MAX_PENDING_PNGS 64
+/* Pending .png files are decoded early once they would use more than this much memory */
+#define MAX_PENDING_MEMORY (32 * 1024 * 1024)
+
+static struct PendingPng {
+	cc_uint8* data;
+	cc_uint32 size;
+	cc_uint32 cost; /* Estimated memory used by compressed and decoded data */
+	cc_result res;
+	struct Bitmap bmp;
+	cc_string name;
+	char nameBuffer[STRING_SIZE];
+} pending_pngs[MAX_PENDING_PNGS];
+/* Indices of pending .png files, sorted from largest to smallest */
+static cc_uint8 pending_order[MAX_PENDING_PNGS];
+static int pending_count;
+static cc_uint32 pending_memory;
+
+static cc_bool IsTextureEntryPng(const cc_string* name) {
+	static const cc_string png = String_FromConst(".png");
+	struct TextureEntry* e;
+	if (!String_CaselessEnds(name, &png)) return false;
+
+	for (e = entries_head; e; e = e->next) 
+	{
+		if (String_CaselessEqualsConst(name, e->filename)) return true;
+	}
+	return false;
+}
+
+/* Estimates size of the decoded image from the width and height in the IHDR chunk */
+static cc_uint32 EstimateDecodedSize(const cc_uint8* data, cc_uint32 size) {
+	cc_uint32 width, height;
+	if (size < PNG_SIG_SIZE + 16 || !Png_Detect(data, size)) return 0;
+
+	width  = Mem_ReadU32_BE(data + PNG_SIG_SIZE + 8);
+	height = Mem_ReadU32_BE(data + PNG_SIG_SIZE + 12);
+	if (width > 0x8000 || height > 0x8000) return MAX_PENDING_MEMORY;
+	return min(width * height * 4, MAX_PENDING_MEMORY);
+}
+
+static void DecodePendingPng(int index) {
+	struct PendingPng* png = &pending_pngs[pending_order[index]];
+	struct Stream stream;
+
+	if (!png->res) {
+		Stream_ReadonlyMemory(&stream, png->data, png->size);
+		png->res = Png_Decode(&png->bmp, &stream);
+	}
+	Mem_Free(png->data);
+	png->data = NULL;
+}
+
+static void ApplyPendingPngs(void) {
+	struct PendingPng* png;
+	struct Stream stream;
+	int i;
+	/* Largest images (e.g. terrain.png) are started first, so they don't end up */
+	/*  being decoded alone at the end while all the other threads are idle */
+	Utils_ParallelFor(pending_count, DecodePendingPng, NULL);
+
+	/* Texture entries are still updated in the same order as the .zip archive */
+	for (i = 0; i < pending_count; i++) 
+	{
+		png = &pending_pngs[i];
+		Png_MakeDecodedStream(&stream, &png->bmp, png->res);
+		Event_RaiseEntry(&TextureEvents.FileChanged, &stream, &png->name);
+
+		/* Only non-NULL when no texture entry took ownership of the image */
+		Mem_Free(png->bmp.scan0);
+	}
+	pending_count  = 0;
+	pending_memory = 0;
+}
+
+static cc_bool QueuePendingPng(const cc_string* name, struct Stream* stream, struct ZipEntry* source) {
+	struct PendingPng* png;
+	cc_uint32 size = source->UncompressedSize;
+	cc_uint8* data;
+	int i;
+
+	if (!size || size >= MAX_PENDING_MEMORY) return false;
+	if (pending_count >= MAX_PENDING_PNGS || pending_memory + size > MAX_PENDING_MEMORY) ApplyPendingPngs();
+
+	data = (cc_uint8*)Mem_TryAlloc(size, 1);
+	if (!data) return false;
+
+	png = &pending_pngs[pending_count];
+	png->data = data;
+	png->size = size;
+	png->bmp.scan0 = NULL;
+
+	String_InitArray(png->name, png->nameBuffer);
+	String_AppendString(&png->name, name);
+	/* Errors are reported by the texture entry when it tries to decode the image */
+	png->res  = Stream_Read(stream, data, size);
+	png->cost = size + (png->res ? 0 : EstimateDecodedSize(data, size));
+
+	/* Insert into decode order, which is sorted by largest first */
+	for (i = pending_count; i > 0 && pending_pngs[pending_order[i - 1]].cost < png->cost; i--)
+	{
+		pending_order[i] = pending_order[i - 1];
+	}
+	pending_order[i] = pending_count++;
+
+	pending_memory += png->cost;
+	if (pending_memory >= MAX_PENDING_MEMORY) ApplyPendingPngs();
+	return true;
+}
+
+static cc_bool SelectZipEntry(const cc_string* path) { return true; }
+static cc_result ProcessZipEntry(const cc_string* path, struct Stream* stream, struct ZipEntry* source) {
+	cc_string name = *path;
+	Utils_UNSAFE_GetFilename(&name);
+
+	if (IsTextureEntryPng(&name) && QueuePendingPng(&name, stream, source)) return 0;
+	Event_RaiseEntry(&TextureEvents.FileChanged, stream, &name);
+	return 0;
+}
+#endif
 
 static cc_result ExtractPng(struct Stream* stream) {
 	struct Bitmap bmp;
@@ -572,6 +707,8 @@ static cc_result ExtractFrom(struct Stream* stream, const cc_string* path) {
 		res = Zip_Extract(stream, SelectZipEntry, ProcessZipEntry,
 							entries, Array_Elems(entries));
 #endif
+		/* Still apply images read before any error, like entries processed before it */
+		ApplyPendingPngs();
 
 		if (res) Logger_SysWarn2(res, "extracting", path);
 	} else if (res) {
@@ -720,12 +857,6 @@ void TexturePack_Extract(const cc_string* url) {
 	TexturePack_ExtractCurrent(false);
 }
 
-static struct TextureEntry* entries_head;
-static struct TextureEntry* entries_tail;
-
-void TextureEntry_Register(struct TextureEntry* entry) {
-	LinkedList_Append(entry, entries_head, entries_tail);
-}
 
 
 /*########################################################################################################################*
@@ -5,6 +5,8 @@
 #include "Stream.h"
 #include "Errors.h"
 #include "Logger.h"
+#include "Funcs.h"
+#include "Game.h"
 
 
 /*########################################################################################################################*
@@ -254,6 +256,209 @@ int Convert_FromBase64(const char* src, int len, cc_uint8* dst) {
 }
 
 
+/*########################################################################################################################*
+*------------------------------------------------------Parallel for-------------------------------------------------------*
+*#########################################################################################################################*/
+#if defined CC_BUILD_COOPTHREADED || defined CC_BUILD_LOWMEM
+void Utils_ParallelFor(int count, Utils_ParallelFunc func, volatile float* progress) {
+	int i;
+	for (i = 0; i < count; i++) 
+	{
+		if (progress) *progress = (float)i / count;
+		func(i);
+	}
+}
+
+struct IGameComponent Utils_Component;
+#else
+/* Maximum number of extra threads used (calling thread also processes indices) */
+#define PARALLEL_MAX_WORKERS 7
+/* Indices are handed out in chunks, with each thread processing roughly this many chunks */
+#define PARALLEL_CHUNKS_PER_THREAD 4
+
+struct ParallelJob {
+	Utils_ParallelFunc func;
+	int count, next, chunkSize;
+	int workers; /* Number of worker threads processing this job */
+	int busy;    /* Number of worker threads yet to finish this job */
+};
+
+static void* parallel_callLock; /* Serialises calls from different threads */
+static void* parallel_lock;     /* Protects all the state below */
+static void* parallel_done;
+static void* parallel_wake[PARALLEL_MAX_WORKERS];
+static void* parallel_threads[PARALLEL_MAX_WORKERS];
+static struct ParallelJob* parallel_job;
+static int parallel_jobID, parallel_maxThreads, parallel_numThreads, parallel_numStarted;
+static cc_bool parallel_quit;
+
+/* Claims the next chunk of indices, returning false once all indices have been claimed */
+static cc_bool ParallelJob_Claim(struct ParallelJob* job, int* beg, int* end) {
+	Mutex_Lock(parallel_lock);
+	{
+		*beg = job->next;
+		*end = min(job->count, *beg + job->chunkSize);
+		job->next = *end;
+	}
+	Mutex_Unlock(parallel_lock);
+	return *beg < *end;
+}
+
+/* NOTE: Only the calling thread reports progress, as worker threads may run at any time */
+static void ParallelJob_Run(struct ParallelJob* job, volatile float* progress) {
+	int i, beg, end;
+	while (ParallelJob_Claim(job, &beg, &end))
+	{
+		if (progress) *progress = (float)beg / job->count;
+		for (i = beg; i < end; i++) job->func(i);
+	}
+}
+
+static void ParallelWorker_Run(void) {
+	struct ParallelJob* job;
+	int index, lastJobID = 0;
+
+	Mutex_Lock(parallel_lock);
+	index = parallel_numStarted++;
+	Mutex_Unlock(parallel_lock);
+
+	for (;;) {
+		Waitable_Wait(parallel_wake[index]);
+
+		Mutex_Lock(parallel_lock);
+		{
+			if (parallel_quit) { Mutex_Unlock(parallel_lock); return; }
+			/* Waitable_Wait may return spuriously, so check there's actually a new job */
+			job = NULL;
+			if (parallel_jobID != lastJobID && index < parallel_job->workers) job = parallel_job;
+			lastJobID = parallel_jobID;
+		}
+		Mutex_Unlock(parallel_lock);
+		if (!job) continue;
+
+		ParallelJob_Run(job, NULL);
+		Mutex_Lock(parallel_lock);
+		{
+			if (--job->busy == 0) Waitable_Signal(parallel_done);
+		}
+		Mutex_Unlock(parallel_lock);
+	}
+}
+
+static void ParallelFor_StartThreads(void) {
+	int i;
+	if (parallel_numThreads) return;
+
+	for (i = 0; i < parallel_maxThreads; i++)
+	{
+		Thread_Run(&parallel_threads[i], ParallelWorker_Run, 128 * 1024, "Parallel worker");
+	}
+	parallel_numThreads = parallel_maxThreads;
+}
+
+void Utils_ParallelFor(int count, Utils_ParallelFunc func, volatile float* progress) {
+	struct ParallelJob job;
+	cc_bool done;
+	int i, workers;
+
+	/* Launcher doesn't initialise game components, and single core systems don't use worker threads */
+	if (count <= 1 || !parallel_callLock) {
+		for (i = 0; i < count; i++) 
+		{
+			if (progress) *progress = (float)i / count;
+			func(i);
+		}
+		return;
+	}
+
+	Mutex_Lock(parallel_callLock);
+	ParallelFor_StartThreads();
+	workers = min(count - 1, parallel_numThreads);
+
+	job.func      = func;
+	job.count     = count;
+	job.next      = 0;
+	job.chunkSize = max(1, count / ((workers + 1) * PARALLEL_CHUNKS_PER_THREAD));
+	job.workers   = workers;
+	job.busy      = workers;
+
+	Mutex_Lock(parallel_lock);
+	{
+		parallel_job = &job;
+		parallel_jobID++;
+	}
+	Mutex_Unlock(parallel_lock);
+
+	for (i = 0; i < workers; i++) 
+	{
+		Waitable_Signal(parallel_wake[i]);
+	}
+	ParallelJob_Run(&job, progress);
+
+	for (;;) {
+		Mutex_Lock(parallel_lock);
+		done = job.busy == 0;
+		Mutex_Unlock(parallel_lock);
+
+		if (done) break;
+		Waitable_Wait(parallel_done);
+	}
+	Mutex_Unlock(parallel_callLock);
+}
+
+static void ParallelFor_Init(void) {
+	int i;
+	parallel_maxThreads = min(Thread_ProcessorCount() - 1, PARALLEL_MAX_WORKERS);
+	if (parallel_maxThreads <= 0) return;
+
+	parallel_lock = Mutex_Create("Parallel job");
+	parallel_done = Waitable_Create("Parallel done");
+
+	for (i = 0; i < parallel_maxThreads; i++)
+	{
+		parallel_wake[i] = Waitable_Create("Parallel wake");
+	}
+	parallel_callLock = Mutex_Create("Parallel for");
+}
+
+static void ParallelFor_Free(void) {
+	void* callLock = parallel_callLock;
+	int i;
+	if (!callLock) return;
+
+	/* Wait for any in-progress call to finish */
+	Mutex_Lock(callLock);
+	parallel_callLock = NULL;
+
+	Mutex_Lock(parallel_lock);
+	parallel_quit = true;
+	Mutex_Unlock(parallel_lock);
+
+	for (i = 0; i < parallel_numThreads; i++)
+	{
+		Waitable_Signal(parallel_wake[i]);
+		Thread_Join(parallel_threads[i]);
+	}
+	parallel_numThreads = 0;
+
+	for (i = 0; i < parallel_maxThreads; i++)
+	{
+		Waitable_Free(parallel_wake[i]);
+	}
+	Waitable_Free(parallel_done);
+	Mutex_Free(parallel_lock);
+
+	Mutex_Unlock(callLock);
+	Mutex_Free(callLock);
+}
+
+struct IGameComponent Utils_Component = {
+	ParallelFor_Init, /* Init */
+	ParallelFor_Free  /* Free */
+};
+#endif
+
+
 /*########################################################################################################################*
 *--------------------------------------------------------EntryList--------------------------------------------------------*
 *#########################################################################################################################*/
@@ -10,6 +10,7 @@ Copyright 2014-2025 ClassiCube | Licensed under BSD-3
 
 struct Bitmap;
 struct StringsBuffer;
+struct IGameComponent;
 /* Represents a particular instance in time in some timezone. Not necessarily UTC time. */
 /* NOTE: TimeMS and DateTime_CurrentUTC() should almost always be used instead. */
 /* This struct should only be used when actually needed. (e.g. log message time) */
@@ -79,6 +80,17 @@ int Convert_ToBase64(const void* data, int len, char* dst);
 int Convert_FromBase64(const char* src, int len, cc_uint8* dst);
 
 
+typedef void (*Utils_ParallelFunc)(int index);
+/* Calls func for every index from 0 to count - 1, spread across multiple threads when supported. */
+/* Returns once func has been called for all indices. */
+/* NOTE: func may be called from multiple threads at once, and indices may be processed in any order. */
+/* NOTE: Calls from different threads are serialised, so func must not itself call Utils_ParallelFor. */
+/* If progress is non-NULL, it is periodically set to roughly how much of the range has been processed. */
+void Utils_ParallelFor(int count, Utils_ParallelFunc func, volatile float* progress);
+/* Starts/stops the worker threads used by Utils_ParallelFor */
+extern struct IGameComponent Utils_Component;
+
+
 typedef cc_bool (*EntryList_Filter)(const cc_string* entry);
 /* Loads the entries from disc. */
 /* NOTE: If separator is \0, does NOT check for duplicate keys when loading. */
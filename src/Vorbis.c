@@ -1,4 +1,10 @@
 #include "Vorbis.h"
+/* Included before Funcs.h, as C++ standard headers may undefine min/max */
+/* NOTE: Define VORBIS_NO_SIMD to force the scalar code (e.g. for comparing output) */
+#if (defined __x86_64__ || defined _M_X64 || defined _M_AMD64) && !defined VORBIS_NO_SIMD
+#include <emmintrin.h>
+#define VORBIS_USE_SSE2
+#endif
 #include "Logger.h"
 #include "Platform.h"
 #include "Event.h"
@@ -191,6 +197,32 @@ static cc_uint32 Vorbis_ReadBit(struct VorbisState* ctx) {
 	return data;
 }
 
+/* Tops up bit buffer with as many whole bytes as will fit, without aborting when the stream ends */
+/* NOTE: Only safe to use while decoding audio packets, since the bitstream is then treated as continuous */
+static void Vorbis_FillBits(struct VorbisState* ctx) {
+	struct OggState* ogg = ctx->source;
+	cc_uint8 portion;
+
+	while (ctx->NumBits <= 24) {
+		if (ogg->left) {
+			Vorbis_PushByte(ctx, *ogg->cur);
+			ogg->cur++; ogg->left--;
+		} else {
+			if (Ogg_ReadU8(ogg, &portion)) return;
+			Vorbis_PushByte(ctx, portion);
+		}
+	}
+}
+
+static cc_uint32 Vorbis_ReverseBits(cc_uint32 v) {
+	v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+	v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+	v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+	v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
+	v = (v >> 16) | (v << 16);
+	return v;
+}
+
 
 /* Vorbis spec 9.2.1. ilog */
 static int iLog(int x) {
@@ -256,6 +288,10 @@ struct Codebook {
 	cc_uint32* codewords;
 	cc_uint32* values;
 	cc_uint32 numCodewords[33]; /* number of codewords of bit length i */
+	/* lookup table indexed by next fastBits bits, of (value << 8) | length */
+	/* NOTE: length of 0 means codeword is longer than fastBits */
+	cc_uint32* fastTable;
+	cc_uint32 fastBits;
 	/* vector quantisation values */
 	float minValue, deltaValue;
 	cc_uint32 sequenceP, lookupType, lookupValues;
@@ -266,6 +302,7 @@ static void Codebook_Free(struct Codebook* c) {
 	Mem_Free(c->codewords);
 	Mem_Free(c->values);
 	Mem_Free(c->multiplicands);
+	Mem_Free(c->fastTable);
 }
 
 static cc_uint32 Codebook_Pow(cc_uint32 base, cc_uint32 exp) {
@@ -359,6 +396,41 @@ static cc_bool Codebook_CalcCodewords(struct Codebook* c, cc_uint8* len) {
 	return true;
 }
 
+#define CODEBOOK_FAST_BITS 10
+static void Codebook_CalcFastTable(struct Codebook* c) {
+	cc_uint32* codewords = c->codewords;
+	cc_uint32* values    = c->values;
+	cc_uint32 i, j, len, code, bits = 0, size;
+
+	for (len = 1; len <= CODEBOOK_FAST_BITS; len++) 
+	{
+		if (c->numCodewords[len]) bits = len;
+	}
+	for (; len < Array_Elems(c->numCodewords); len++) 
+	{
+		if (c->numCodewords[len]) bits = CODEBOOK_FAST_BITS;
+	}
+
+	size = 1U << bits;
+	c->fastBits  = bits;
+	c->fastTable = (cc_uint32*)Mem_AllocCleared(size, 4, "codebook fast table");
+
+	for (len = 1; len <= bits; len++) 
+	{
+		for (i = 0; i < c->numCodewords[len]; i++) 
+		{
+			/* codewords are stored MSB first, but bits are read LSB first */
+			code = Vorbis_ReverseBits(codewords[i]);
+			for (j = code; j < size; j += 1U << len) 
+			{
+				c->fastTable[j] = (values[i] << 8) | len;
+			}
+		}
+		codewords += c->numCodewords[len];
+		values    += c->numCodewords[len];
+	}
+}
+
 static cc_result Codebook_DecodeSetup(struct VorbisState* ctx, struct Codebook* c) {
 	cc_uint32 sync;
 	cc_uint8* codewordLens;
@@ -413,6 +485,7 @@ static cc_result Codebook_DecodeSetup(struct VorbisState* ctx, struct Codebook*
 
 	c->totalCodewords = entry;
 	Codebook_CalcCodewords(c, codewordLens);
+	Codebook_CalcFastTable(c);
 	Mem_Free(codewordLens);
 
 	c->lookupType    = Vorbis_ReadBits(ctx, 4);
@@ -440,12 +513,12 @@ static cc_result Codebook_DecodeSetup(struct VorbisState* ctx, struct Codebook*
 	return 0;
 }
 
-static cc_uint32 Codebook_DecodeScalar(struct VorbisState* ctx, struct Codebook* c) {
+/* Decodes codewords longer than fastBits, or when near the end of the stream */
+static cc_uint32 Codebook_DecodeSlow(struct VorbisState* ctx, struct Codebook* c) {
 	cc_uint32 codeword = 0, shift = 31, depth, i;
 	cc_uint32* codewords = c->codewords;
 	cc_uint32* values    = c->values;
 
-	/* TODO: This is so massively slow */
 	for (depth = 1; depth <= 32; depth++, shift--) 
 	{
 		codeword |= Vorbis_ReadBit(ctx) << shift;
@@ -463,6 +536,18 @@ static cc_uint32 Codebook_DecodeScalar(struct VorbisState* ctx, struct Codebook*
 	return -1;
 }
 
+static cc_uint32 Codebook_DecodeScalar(struct VorbisState* ctx, struct Codebook* c) {
+	cc_uint32 entry, len;
+	Vorbis_FillBits(ctx);
+
+	entry = c->fastTable[Vorbis_PeekBits(ctx, c->fastBits)];
+	len   = entry & 0xFF;
+	if (!len || len > ctx->NumBits) return Codebook_DecodeSlow(ctx, c);
+
+	Vorbis_ConsumeBits(ctx, len);
+	return entry >> 8;
+}
+
 static void Codebook_DecodeVectors(struct VorbisState* ctx, struct Codebook* c, float* v, int step) {
 	cc_uint32 lookupOffset = Codebook_DecodeScalar(ctx, c);
 	float last = 0.0f, value;
@@ -1060,14 +1145,6 @@ static cc_result Mapping_DecodeSetup(struct VorbisState* ctx, struct Mapping* m)
 *------------------------------------------------------imdct impl---------------------------------------------------------*
 *#########################################################################################################################*/
 #define PI MATH_PI
-static cc_uint32 Vorbis_ReverseBits(cc_uint32 v) {
-	v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
-	v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
-	v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
-	v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
-	v = (v >> 16) | (v << 16);
-	return v;
-}
 
 void imdct_init(struct imdct_state* state, int n) {
 	int k, k2, n4 = n >> 2, n8 = n >> 3, log2_n;
@@ -1098,6 +1175,156 @@ void imdct_init(struct imdct_state* state, int n) {
 	}
 }
 
+/* NOTE: SSE2 is always available on x86-64, so no runtime detection is needed */
+#ifdef VORBIS_USE_SSE2
+#define imdct_Reverse(x) _mm_shuffle_ps(x, x, _MM_SHUFFLE(0,1,2,3))
+#define imdct_Negate(x)  _mm_xor_ps(x, _mm_set1_ps(-0.0f))
+/* Splits 8 interleaved values into the even indexed and odd indexed values */
+#define imdct_Deinterleave(lo, hi, even, odd) \
+	even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2,0,2,0)); \
+	odd  = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3,1,3,1));
+/* Loads values at index 'i - 1 - 2k' and 'i - 2 - 2k', for k = 0 to 3 */
+#define imdct_LoadReversedPairs(src, i, first, second) \
+	lo = _mm_loadu_ps(src + i - 8); hi = _mm_loadu_ps(src + i - 4); \
+	first  = _mm_shuffle_ps(hi, lo, _MM_SHUFFLE(1,3,1,3)); \
+	second = _mm_shuffle_ps(hi, lo, _MM_SHUFFLE(0,2,0,2));
+
+/* Performs step 1 and step 2 for four values of k at a time, returns number of k values done */
+/* NOTE: Operations are done in the same order as the scalar code, so results are identical */
+static int imdct_step1_SSE2(const float* in, float* w, const float* A, int n) {
+	int k, k2, k4, n2 = n >> 1, n4 = n >> 2, n8 = n >> 3;
+	__m128 lo, hi, a, b, c, d;
+	__m128 e_1, e_2, f_1, f_2, g_1, g_2, h_1, h_2;
+	__m128 A_1, A_2, A_3, A_4, A_5, A_6;
+
+	for (k = 0, k2 = 0, k4 = 0; k + 4 <= n8; k += 4, k2 += 8, k4 += 16) 
+	{
+		/* e_1 = -in[k4+3], e_2 = -in[k4+1] */
+		a = _mm_loadu_ps(in + k4);     b = _mm_loadu_ps(in + k4 + 4);
+		c = _mm_loadu_ps(in + k4 + 8); d = _mm_loadu_ps(in + k4 + 12);
+		lo = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));
+		hi = _mm_shuffle_ps(c, d, _MM_SHUFFLE(3,1,3,1));
+		imdct_Deinterleave(lo, hi, e_2, e_1);
+		e_1 = imdct_Negate(e_1); e_2 = imdct_Negate(e_2);
+
+		/* f_1 = in[n2-4-k4], f_2 = in[n2-2-k4] */
+		a = _mm_loadu_ps(in + n2-4-k4);  b = _mm_loadu_ps(in + n2-8-k4);
+		c = _mm_loadu_ps(in + n2-12-k4); d = _mm_loadu_ps(in + n2-16-k4);
+		lo = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+		hi = _mm_shuffle_ps(c, d, _MM_SHUFFLE(2,0,2,0));
+		imdct_Deinterleave(lo, hi, f_1, f_2);
+
+		/* A_5 = A[n2-4-k4], A_6 = A[n2-3-k4] */
+		a = _mm_loadu_ps(A + n2-4-k4);  b = _mm_loadu_ps(A + n2-8-k4);
+		c = _mm_loadu_ps(A + n2-12-k4); d = _mm_loadu_ps(A + n2-16-k4);
+		lo = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1,0,1,0));
+		hi = _mm_shuffle_ps(c, d, _MM_SHUFFLE(1,0,1,0));
+		imdct_Deinterleave(lo, hi, A_5, A_6);
+
+		imdct_LoadReversedPairs(A, n2-k2, A_1, A_2);
+		imdct_LoadReversedPairs(A, n4-k2, A_3, A_4);
+
+		g_1 = _mm_add_ps(_mm_mul_ps(e_1, A_1), _mm_mul_ps(e_2, A_2));
+		g_2 = _mm_sub_ps(_mm_mul_ps(e_1, A_2), _mm_mul_ps(e_2, A_1));
+		h_2 = _mm_sub_ps(_mm_mul_ps(f_1, A_4), _mm_mul_ps(f_2, A_3));
+		h_1 = _mm_add_ps(_mm_mul_ps(f_1, A_3), _mm_mul_ps(f_2, A_4));
+
+		a = _mm_add_ps(h_1, g_1); b = _mm_add_ps(h_2, g_2);
+		_mm_storeu_ps(w + n4 + k2,     _mm_unpacklo_ps(a, b));
+		_mm_storeu_ps(w + n4 + k2 + 4, _mm_unpackhi_ps(a, b));
+
+		c = _mm_sub_ps(h_1, g_1); d = _mm_sub_ps(h_2, g_2);
+		a = _mm_add_ps(_mm_mul_ps(c, A_5), _mm_mul_ps(d, A_6));
+		b = _mm_sub_ps(_mm_mul_ps(d, A_5), _mm_mul_ps(c, A_6));
+		_mm_storeu_ps(w + k2,     _mm_unpacklo_ps(a, b));
+		_mm_storeu_ps(w + k2 + 4, _mm_unpackhi_ps(a, b));
+	}
+	return k;
+}
+
+/* Loads the pairs of values at 'src[i]' and 'src[i+1]', for each of four indices */
+static CC_INLINE void imdct_GatherPairs(const float* src, int i0, int i1, int i2, int i3, __m128* even, __m128* odd) {
+	__m128 lo = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double*)(src + i0)), (const double*)(src + i1)));
+	__m128 hi = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double*)(src + i2)), (const double*)(src + i3)));
+	*even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2,0,2,0));
+	*odd  = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3,1,3,1));
+}
+
+/* Performs steps 4 to 8 for four values of k at a time, returns number of k values done */
+/* NOTE: Operations are done in the same order as the scalar code, so results are identical */
+static int imdct_step4_SSE2(const float* u, float* out, const float* B, const float* C, const cc_uint32* reversed, int n) {
+	int k, k2, n2 = n >> 1, n4 = n >> 2, n8 = n >> 3, n3_4 = n - n4;
+	__m128 lo, hi, half = _mm_set1_ps(-0.5f);
+	__m128 e_1, e_2, f_1, f_2, g_1, g_2, h_1, h_2;
+	__m128 x_1, x_2, y_1, y_2, s, d, t;
+	__m128 B_1, B_2, B_3, B_4, C_1, C_2;
+	int j0, j1, j2, j3;
+
+	for (k = 0, k2 = 0; k + 4 <= n8; k += 4, k2 += 8) 
+	{
+		j0 = reversed[k] << 2; j1 = reversed[k+1] << 2; j2 = reversed[k+2] << 2; j3 = reversed[k+3] << 2;
+		imdct_GatherPairs(u, n2-j0-2, n2-j1-2, n2-j2-2, n2-j3-2, &e_2, &e_1);
+		imdct_GatherPairs(u, j0, j1, j2, j3, &f_2, &f_1);
+
+		lo = _mm_loadu_ps(C + k2); hi = _mm_loadu_ps(C + k2 + 4);
+		imdct_Deinterleave(lo, hi, C_1, C_2);
+		lo = _mm_loadu_ps(B + k2); hi = _mm_loadu_ps(B + k2 + 4);
+		imdct_Deinterleave(lo, hi, B_1, B_2);
+		imdct_LoadReversedPairs(B, n2-k2, B_4, B_3);
+
+		s = _mm_add_ps(e_1, f_1); d = _mm_sub_ps(e_1, f_1);
+		t = _mm_add_ps(e_2, f_2);
+
+		g_1 = _mm_add_ps(_mm_add_ps(s, _mm_mul_ps(C_2, d)), _mm_mul_ps(C_1, t));
+		h_1 = _mm_sub_ps(_mm_sub_ps(s, _mm_mul_ps(C_2, d)), _mm_mul_ps(C_1, t));
+		g_2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(e_2, f_2), _mm_mul_ps(C_2, t)), _mm_mul_ps(C_1, d));
+		h_2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(f_2, e_2), _mm_mul_ps(C_2, t)), _mm_mul_ps(C_1, d));
+
+		x_1 = _mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(g_1, B_1), _mm_mul_ps(g_2, B_2)));
+		x_2 = _mm_mul_ps(half, _mm_sub_ps(_mm_mul_ps(g_1, B_2), _mm_mul_ps(g_2, B_1)));
+		_mm_storeu_ps(out + n4-4-k,   imdct_Reverse(imdct_Negate(x_2)));
+		_mm_storeu_ps(out + n4+k,     x_2);
+		_mm_storeu_ps(out + n3_4-4-k, imdct_Reverse(x_1));
+		_mm_storeu_ps(out + n3_4+k,   x_1);
+
+		y_1 = _mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(h_1, B_3), _mm_mul_ps(h_2, B_4)));
+		y_2 = _mm_mul_ps(half, _mm_sub_ps(_mm_mul_ps(h_1, B_4), _mm_mul_ps(h_2, B_3)));
+		_mm_storeu_ps(out + k,        imdct_Negate(y_2));
+		_mm_storeu_ps(out + n2-4-k,   imdct_Reverse(y_2));
+		_mm_storeu_ps(out + n2+k,     y_1);
+		_mm_storeu_ps(out + n-4-k,    imdct_Reverse(y_1));
+	}
+	return k;
+}
+
+/* Performs step 3 butterflies for two values of r at a time, returns number of r values done */
+/* NOTE: Operations are done in the same order as the scalar code, so results are identical */
+static int imdct_step3_SSE2(const float* w, float* u, const float* A, int n2, int k0, int k1, int rMax, int s2Max) {
+	__m128 e, f, d, a0, a1;
+	int r, r2, s2, i;
+
+	for (r = 0, r2 = 0; r + 2 <= rMax; r += 2, r2 += 4) 
+	{
+		/* lanes 0,1 hold values for r+1, lanes 2,3 hold values for r */
+		a0 = _mm_set_ps( A[r*k1],   A[r*k1],   A[(r+1)*k1],    A[(r+1)*k1]);
+		a1 = _mm_set_ps(-A[r*k1+1], A[r*k1+1], -A[(r+1)*k1+1], A[(r+1)*k1+1]);
+
+		for (s2 = 0; s2 < s2Max; s2 += 2) 
+		{
+			i = n2-4-k0*s2-r2;
+			e = _mm_loadu_ps(w + i);
+			f = _mm_loadu_ps(w + i - k0);
+			_mm_storeu_ps(u + i, _mm_add_ps(e, f));
+
+			d = _mm_sub_ps(e, f);
+			d = _mm_add_ps(_mm_mul_ps(d, a0), _mm_mul_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(2,3,0,1)), a1));
+			_mm_storeu_ps(u + i - k0, d);
+		}
+	}
+	return r;
+}
+#endif
+
 void imdct_calc(float* in, float* out, struct imdct_state* state) {
 	int k, k2, k4, n = state->n;
 	int n2 = n >> 1, n4 = n >> 2, n8 = n >> 3, n3_4 = n - n4;
@@ -1108,15 +1335,22 @@ void imdct_calc(float* in, float* out, struct imdct_state* state) {
 	/* Uses a few fixes for the paper noted at http://www.nothings.org/stb_vorbis/mdct_01.txt */
 	float *A = state->a, *B = state->b, *C = state->c;
 
-	float u[VORBIS_MAX_BLOCK_SIZE / 2];
-	float w[VORBIS_MAX_BLOCK_SIZE / 2];
+	float bufferA[VORBIS_MAX_BLOCK_SIZE / 2];
+	float bufferB[VORBIS_MAX_BLOCK_SIZE / 2];
+	float* u = bufferA;
+	float* w = bufferB;
+	float* tmp;
 	float e_1, e_2, f_1, f_2;
 	float g_1, g_2, h_1, h_2;
 	float x_1, x_2, y_1, y_2;
 
 
 	/* spectral coefficients, step 1, step 2 */ /* TODO avoid k */
-	for (k = 0, k2 = 0, k4 = 0; k < n8; k++, k2 += 2, k4 += 4) 
+	k = 0;
+#ifdef VORBIS_USE_SSE2
+	k = imdct_step1_SSE2(in, w, A, n);
+#endif
+	for (k2 = k * 2, k4 = k * 4; k < n8; k++, k2 += 2, k4 += 4) 
 	{
 		e_1 = -in[k4+3];   e_2 = -in[k4+1];
 		g_1 = e_1 * A[n2-1-k2] + e_2 * A[n2-2-k2];
@@ -1138,9 +1372,12 @@ void imdct_calc(float* in, float* out, struct imdct_state* state) {
 	for (l = 0; l <= log2_n - 4; l++) 
 	{
 		int k0 = n >> (l+3), k1 = 1 << (l+3);
-		int r, r2, rMax = n >> (l+4), s2, s2Max = 1 << (l+2);
+		int r = 0, r2, rMax = n >> (l+4), s2, s2Max = 1 << (l+2);
 
-		for (r = 0, r2 = 0; r < rMax; r++, r2 += 2) 
+#ifdef VORBIS_USE_SSE2
+		r = imdct_step3_SSE2(w, u, A, n2, k0, k1, rMax, s2Max);
+#endif
+		for (r2 = r * 2; r < rMax; r++, r2 += 2) 
 		{
 			for (s2 = 0; s2 < s2Max; s2 += 2) 
 			{
@@ -1156,16 +1393,20 @@ void imdct_calc(float* in, float* out, struct imdct_state* state) {
 			}
 		}
 
-		/* TODO: eliminate this, do w/u in-place */
+		/* every value of u is written each step, so just swap buffers around */
 		/* TODO: dynamically allocate mem for imdct */
 		if (l+1 <= log2_n - 4) {
-			Mem_Copy(w, u, n2 * sizeof(float));
+			tmp = w; w = u; u = tmp;
 		}
 	}
 
 	/* step 4, step 5, step 6, step 7, step 8, output */
 	reversed = state->reversed;
-	for (k = 0, k2 = 0; k < n8; k++, k2 += 2) 
+	k = 0;
+#ifdef VORBIS_USE_SSE2
+	k = imdct_step4_SSE2(u, out, B, C, reversed, n);
+#endif
+	for (k2 = k * 2; k < n8; k++, k2 += 2) 
 	{
 		cc_uint32 j = reversed[k], j4 = j << 2;
 		e_1 = u[n2-j4-1]; e_2 = u[n2-j4-2];
@@ -1587,6 +1828,72 @@ cc_result Vorbis_DecodeFrame(struct VorbisState* ctx) {
 	return 0;
 }
 
+/* Clamps sample to between -1 and 1, then converts it to int16 range */
+/* NaN is output as silence, as casting it to an integer is undefined behaviour */
+static CC_INLINE cc_int16 Vorbis_ConvertSample(float sample) {
+	if (sample != sample) return 0;
+	Math_Clamp(sample, -1.0f, 1.0f);
+	return (cc_int16)(sample * 32767);
+}
+
+#ifdef VORBIS_USE_SSE2
+/* Clamps 4 samples to between -1 and 1, then converts them to int16 range */
+/* NOTE: Must give the same results as Vorbis_ConvertSample, including for NaN */
+static CC_INLINE __m128i Vorbis_ConvertSamples_SSE2(__m128 sample) {
+	sample = _mm_and_ps(sample, _mm_cmpord_ps(sample, sample)); /* NaN lanes to 0 */
+	sample = _mm_min_ps(_mm_max_ps(sample, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+	return _mm_cvttps_epi32(_mm_mul_ps(sample, _mm_set1_ps(32767.0f)));
+}
+
+/* Interleaves and stores 4 samples from 1 or 2 channels */
+static CC_INLINE void Vorbis_StoreSamples_SSE2(cc_int16* data, __m128i l, __m128i r, int channels) {
+	if (channels == 1) {
+		_mm_storel_epi64((__m128i*)data, _mm_packs_epi32(l, l));
+	} else {
+		_mm_storeu_si128((__m128i*)data, _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)));
+	}
+}
+
+/* Converts 4 samples per channel at a time, returns number of samples done */
+/* NOTE: Only mono and stereo are handled, other channel layouts use the scalar code */
+static int Vorbis_OutputSamples_SSE2(cc_int16* data, float** src, int count, int channels) {
+	__m128i l, r;
+	int i;
+	if (channels > 2) return 0;
+
+	for (i = 0; i + 4 <= count; i += 4, data += channels * 4) 
+	{
+		l = Vorbis_ConvertSamples_SSE2(_mm_loadu_ps(src[0] + i));
+		r = channels == 2 ? Vorbis_ConvertSamples_SSE2(_mm_loadu_ps(src[1] + i)) : l;
+		Vorbis_StoreSamples_SSE2(data, l, r, channels);
+	}
+	return i;
+}
+
+/* Windows, overlaps and converts 4 samples per channel at a time, returns number of samples done */
+/* NOTE: Only mono and stereo are handled, other channel layouts use the scalar code */
+static int Vorbis_OverlapSamples_SSE2(cc_int16* data, float** prev, float** cur, struct VorbisWindow* window, int count, int channels) {
+	__m128 wPrev, wCur;
+	__m128i s[2];
+	int i, ch;
+	if (channels > 2) return 0;
+
+	for (i = 0; i + 4 <= count; i += 4, data += channels * 4) 
+	{
+		wPrev = _mm_loadu_ps(window->Prev + i);
+		wCur  = _mm_loadu_ps(window->Cur  + i);
+
+		for (ch = 0; ch < channels; ch++) 
+		{
+			s[ch] = Vorbis_ConvertSamples_SSE2(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(prev[ch] + i), wPrev),
+															_mm_mul_ps(_mm_loadu_ps(cur[ch]  + i), wCur)));
+		}
+		Vorbis_StoreSamples_SSE2(data, s[0], s[channels - 1], channels);
+	}
+	return i;
+}
+#endif
+
 int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 	struct VorbisWindow window;
 	float* prev[VORBIS_MAX_CHANS];
@@ -1594,7 +1901,6 @@ int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 
 	int curQrtr, prevQrtr, overlapQtr;
 	int curOffset, prevOffset, overlapSize;
-	float sample;
 	int i, ch;
 
 	/* first frame decoded has no data */
@@ -1628,13 +1934,16 @@ int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 	}
 
 	/* for long prev and short cur block, there will be non-overlapped data before */
-	for (i = 0; i < prevOffset; i++) 
+	i = 0;
+#ifdef VORBIS_USE_SSE2
+	i = Vorbis_OutputSamples_SSE2(data, prev, prevOffset, ctx->channels);
+	data += i * ctx->channels;
+#endif
+	for (; i < prevOffset; i++) 
 	{
 		for (ch = 0; ch < ctx->channels; ch++) 
 		{
-			sample = prev[ch][i];
-			Math_Clamp(sample, -1.0f, 1.0f);
-			*data++ = (cc_int16)(sample * 32767);
+			*data++ = Vorbis_ConvertSample(prev[ch][i]);
 		}
 	}
 
@@ -1649,25 +1958,31 @@ int Vorbis_OutputFrame(struct VorbisState* ctx, cc_int16* data) {
 
 	/* overlap and add data */
 	/* also perform windowing here */
-	for (i = 0; i < overlapSize; i++) 
+	i = 0;
+#ifdef VORBIS_USE_SSE2
+	i = Vorbis_OverlapSamples_SSE2(data, prev, cur, &window, overlapSize, ctx->channels);
+	data += i * ctx->channels;
+#endif
+	for (; i < overlapSize; i++) 
 	{
 		for (ch = 0; ch < ctx->channels; ch++) 
 		{
-			sample = prev[ch][i] * window.Prev[i] + cur[ch][i] * window.Cur[i];
-			Math_Clamp(sample, -1.0f, 1.0f);
-			*data++ = (cc_int16)(sample * 32767);
+			*data++ = Vorbis_ConvertSample(prev[ch][i] * window.Prev[i] + cur[ch][i] * window.Cur[i]);
 		}
 	}
 
 	/* for long cur and short prev block, there will be non-overlapped data after */
 	for (i = 0; i < ctx->channels; i++) { cur[i] += overlapSize; }
-	for (i = 0; i < curOffset; i++) 
+	i = 0;
+#ifdef VORBIS_USE_SSE2
+	i = Vorbis_OutputSamples_SSE2(data, cur, curOffset, ctx->channels);
+	data += i * ctx->channels;
+#endif
+	for (; i < curOffset; i++) 
 	{
 		for (ch = 0; ch < ctx->channels; ch++) 
 		{
-			sample = cur[ch][i];
-			Math_Clamp(sample, -1.0f, 1.0f);
-			*data++ = (cc_int16)(sample * 32767);
+			*data++ = Vorbis_ConvertSample(cur[ch][i]);
 		}
 	}
 
@@ -2076,7 +2076,9 @@ void TextGroupWidget_ShiftUp(struct TextGroupWidget* w) {
 
 	for (i = 0; i < last; i++) 
 	{
-		w->textures[i] = w->textures[i + 1];
+		w->textures[i]    = w->textures[i + 1];
+		w->lineLengths[i] = w->lineLengths[i + 1];
+		Mem_Copy(w->lineTexts[i], w->lineTexts[i + 1], STRING_SIZE);
 	}
 	w->textures[last].ID = 0; /* Gfx_DeleteTexture() called by TextGroupWidget_Redraw otherwise */
 	TextGroupWidget_Redraw(w, last);
@@ -2089,7 +2091,9 @@ void TextGroupWidget_ShiftDown(struct TextGroupWidget* w) {
 
 	for (i = last; i > 0; i--) 
 	{
-		w->textures[i] = w->textures[i - 1];
+		w->textures[i]    = w->textures[i - 1];
+		w->lineLengths[i] = w->lineLengths[i - 1];
+		Mem_Copy(w->lineTexts[i], w->lineTexts[i - 1], STRING_SIZE);
 	}
 	w->textures[0].ID = 0; /* Gfx_DeleteTexture() called by TextGroupWidget_Redraw otherwise */
 	TextGroupWidget_Redraw(w, 0);
@@ -2402,13 +2406,30 @@ void TextGroupWidget_RedrawAll(struct TextGroupWidget* w) {
 	for (i = 0; i < w->lines; i++) { TextGroupWidget_Redraw(w, i); }
 }
 
+/* Whether the given line's texture was last drawn from the same text */
+static cc_bool TextGroupWidget_SameText(struct TextGroupWidget* w, int index, const cc_string* text) {
+	return w->lineLengths[index] == text->length && Mem_Equal(w->lineTexts[index], text->buffer, text->length);
+}
+
+static void TextGroupWidget_StoreText(struct TextGroupWidget* w, int index, const cc_string* text) {
+	if (text->length > STRING_SIZE) { w->lineLengths[index] = -1; return; }
+
+	w->lineLengths[index] = text->length;
+	Mem_Copy(w->lineTexts[index], text->buffer, text->length);
+}
+
 void TextGroupWidget_Redraw(struct TextGroupWidget* w, int index) {
 	cc_string text;
 	struct DrawTextArgs args;
 	struct Texture tex = { 0 };
-	Gfx_DeleteTexture(&w->textures[index].ID);
 
+	/* Servers often resend identical status/announcement text every tick */
 	text = TextGroupWidget_UNSAFE_Get(w, index);
+	if (w->textures[index].ID && TextGroupWidget_SameText(w, index, &text)) return;
+
+	Gfx_DeleteTexture(&w->textures[index].ID);
+	TextGroupWidget_StoreText(w, index, &text);
+
 	if (!Drawer2D_IsEmptyText(&text)) {
 		DrawTextArgs_Make(&args, &text, w->font, true);
 
@@ -2439,6 +2460,7 @@ void TextGroupWidget_RedrawAllWithCol(struct TextGroupWidget* group, char col) {
 		for (j = 0; j < line.length - 1; j++) 
 		{
 			if (line.buffer[j] == '&' && line.buffer[j + 1] == col) {
+				group->lineLengths[i] = -1;
 				TextGroupWidget_Redraw(group, i);
 				break;
 			}
@@ -2457,6 +2479,7 @@ void TextGroupWidget_SetFont(struct TextGroupWidget* w, struct FontDesc* font) {
 	for (i = 0; i < w->lines; i++) 
 	{
 		w->textures[i].height = w->collapsible[i] ? 0 : height;
+		w->lineLengths[i]     = -1;
 	}
 	w->font = font;
 	Widget_Layout(w);
@@ -2526,6 +2549,7 @@ void TextGroupWidget_Create(struct TextGroupWidget* w, int lines, struct Texture
 	w->lines    = lines;
 	w->textures = textures;
 	w->GetLine  = getLine;
+	Mem_Set(w->lineLengths, 0xFF, sizeof(w->lineLengths));
 }
 void TextGroupWidget_Add(void* screen, struct TextGroupWidget* w, int lines, struct Texture* textures, TextGroupWidget_Get getLine) {
 	TextGroupWidget_Create(w, lines, textures, getLine);
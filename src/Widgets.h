@@ -256,6 +256,10 @@ struct TextGroupWidget {
 	cc_bool underlineUrls;
 	struct Texture* textures;
 	TextGroupWidget_Get GetLine;
+	/* Text each line's texture was last drawn from, used to avoid redrawing lines whose text hasn't changed */
+	/* (length of -1 means unknown, e.g. when the text was too long to store) */
+	cc_int8 lineLengths[GUI_MAX_CHATLINES];
+	char lineTexts[GUI_MAX_CHATLINES][STRING_SIZE];
 };
 
 CC_NOINLINE void TextGroupWidget_Create(struct TextGroupWidget* w, int lines, struct Texture* textures, TextGroupWidget_Get getLine);
@@ -10,9 +10,126 @@
 #include "Game.h"
 #include "TexturePack.h"
 #include "Window.h"
+#include "Funcs.h"
+#include "Errors.h"
 
 struct _WorldData World;
 static char nameBuffer[STRING_SIZE];
+/*########################################################################################################################*
+*-----------------------------------------------------World snapshot------------------------------------------------------*
+*#########################################################################################################################*/
+static struct WorldSnapshot {
+	void* mutex;
+	BlockRaw* blocks;
+	BlockRaw* blocks2;  /* NULL when upper 8 bits of blocks are not part of the snapshot */
+	BlockRaw** pages;   /* Original contents of pages changed since snapshot began, NULL if unchanged */
+	cc_uint32 volume;
+	cc_bool owned;      /* Whether snapshot is responsible for freeing blocks arrays */
+	cc_result result;
+} snapshot;
+/* Whether changing blocks needs to preserve the original contents of pages first */
+static cc_bool snapshot_tracking;
+
+cc_bool World_BeginSnapshot(void) {
+	int pagesCount = (World.Volume + WORLD_SNAPSHOT_PAGE_SIZE - 1) >> WORLD_SNAPSHOT_PAGE_SHIFT;
+	if (snapshot.pages || !World.Blocks) return false;
+
+	snapshot.pages = (BlockRaw**)Mem_TryAllocCleared(pagesCount, sizeof(BlockRaw*));
+	if (!snapshot.pages) return false;
+	if (!snapshot.mutex) snapshot.mutex = Mutex_Create("World snapshot");
+
+	snapshot.blocks  = World.Blocks;
+	snapshot.blocks2 = NULL;
+#ifdef EXTENDED_BLOCKS
+	if (World.Blocks != World.Blocks2) snapshot.blocks2 = World.Blocks2;
+#endif
+	snapshot.volume  = World.Volume;
+	snapshot.owned   = false;
+	snapshot.result  = 0;
+
+	snapshot_tracking = true;
+	return true;
+}
+
+static CC_NOINLINE void World_PreservePage(int i) {
+	int page = i >> WORLD_SNAPSHOT_PAGE_SHIFT;
+	cc_uint32 offset, count;
+	BlockRaw* copy;
+	if (snapshot.pages[page]) return;
+
+	offset = page << WORLD_SNAPSHOT_PAGE_SHIFT;
+	count  = min(WORLD_SNAPSHOT_PAGE_SIZE, snapshot.volume - offset);
+	copy   = (BlockRaw*)Mem_TryAlloc(snapshot.blocks2 ? 2 : 1, WORLD_SNAPSHOT_PAGE_SIZE);
+
+	Mutex_Lock(snapshot.mutex);
+	if (copy) {
+		Mem_Copy(copy, snapshot.blocks + offset, count);
+		if (snapshot.blocks2) Mem_Copy(copy + WORLD_SNAPSHOT_PAGE_SIZE, snapshot.blocks2 + offset, count);
+		snapshot.pages[page] = copy;
+	} else {
+		/* Snapshot can no longer be consistent */
+		snapshot.result   = ERR_OUT_OF_MEMORY;
+		snapshot_tracking = false;
+	}
+	Mutex_Unlock(snapshot.mutex);
+}
+
+cc_result World_ReadSnapshot(cc_uint32 offset, cc_uint32 count, cc_bool upper, BlockRaw* dst) {
+	BlockRaw* page;
+	BlockRaw* src;
+	cc_result res;
+
+	Mutex_Lock(snapshot.mutex);
+	{
+		page = snapshot.pages[offset >> WORLD_SNAPSHOT_PAGE_SHIFT];
+		res  = snapshot.result;
+
+		if (page) {
+			src = page + (upper ? WORLD_SNAPSHOT_PAGE_SIZE : 0);
+		} else {
+			src = (upper ? snapshot.blocks2 : snapshot.blocks) + offset;
+		}
+		if (!res) Mem_Copy(dst, src, count);
+	}
+	Mutex_Unlock(snapshot.mutex);
+	return res;
+}
+
+void World_EndSnapshot(void) {
+	int i, pagesCount = (snapshot.volume + WORLD_SNAPSHOT_PAGE_SIZE - 1) >> WORLD_SNAPSHOT_PAGE_SHIFT;
+	if (!snapshot.pages) return;
+	snapshot_tracking = false;
+
+	Mutex_Lock(snapshot.mutex);
+	{
+		for (i = 0; i < pagesCount; i++) Mem_Free(snapshot.pages[i]);
+		Mem_Free(snapshot.pages);
+		snapshot.pages = NULL;
+
+		if (snapshot.owned) {
+			Mem_Free(snapshot.blocks);
+			Mem_Free(snapshot.blocks2);
+		}
+		snapshot.blocks  = NULL;
+		snapshot.blocks2 = NULL;
+	}
+	Mutex_Unlock(snapshot.mutex);
+}
+
+/* Hands ownership of the blocks arrays over to the snapshot, if it is still being read from */
+static cc_bool World_HandoverBlocks(void) {
+	if (!snapshot.pages) return false;
+	/* World may have been reset again (e.g. failed to load next map) while the save is still running */
+	if (snapshot.owned || World.Blocks != snapshot.blocks) return false;
+	snapshot_tracking = false;
+
+	Mutex_Lock(snapshot.mutex);
+	snapshot.owned = true;
+	Mutex_Unlock(snapshot.mutex);
+	return true;
+}
+
+
 /*########################################################################################################################*
 *----------------------------------------------------------World----------------------------------------------------------*
 *#########################################################################################################################*/
@@ -38,12 +155,14 @@ static void GenerateNewUuid(void) {
 }
 
 void World_Reset(void) {
+	/* Background save may still be reading the blocks, in which case it frees them later instead */
+	cc_bool handedOver = World_HandoverBlocks();
 #ifdef EXTENDED_BLOCKS
-	if (World.Blocks != World.Blocks2) Mem_Free(World.Blocks2);
+	if (World.Blocks != World.Blocks2 && !(handedOver && snapshot.blocks2)) Mem_Free(World.Blocks2);
 	World.Blocks2 = NULL;
 	World.IDMask  = 0xFF;
 #endif
-	Mem_Free(World.Blocks);
+	if (!handedOver) Mem_Free(World.Blocks);
 	World.Blocks = NULL;
 	String_InitArray(World.Name, nameBuffer);
 
@@ -124,6 +243,7 @@ static CC_NOINLINE void LazyInitUpper(int i, BlockID block) {
 
 void World_SetBlock(int x, int y, int z, BlockID block) {
 	int i = World_Pack(x, y, z);
+	if (snapshot_tracking) World_PreservePage(i);
 	World.Blocks[i] = (BlockRaw)block;
 
 	/* defer allocation of second map array if possible */
@@ -136,7 +256,9 @@ void World_SetBlock(int x, int y, int z, BlockID block) {
 }
 #else
 void World_SetBlock(int x, int y, int z, BlockID block) {
-	World.Blocks[World_Pack(x, y, z)] = block; 
+	int i = World_Pack(x, y, z);
+	if (snapshot_tracking) World_PreservePage(i);
+	World.Blocks[i] = block; 
 }
 #endif
 
@@ -75,6 +75,18 @@ CC_API void World_SetNewMap(BlockRaw* blocks, int width, int height, int length)
 CC_NOINLINE void World_SetDimensions(int width, int height, int length);
 void World_OutOfMemory(void);
 
+#define WORLD_SNAPSHOT_PAGE_SHIFT 16
+#define WORLD_SNAPSHOT_PAGE_SIZE  (1 << WORLD_SNAPSHOT_PAGE_SHIFT)
+/* Begins a copy-on-write snapshot of the world's blocks, e.g. for saving the world in the background */
+/* NOTE: Pages of blocks are only copied when a block in them is about to be changed */
+cc_bool World_BeginSnapshot(void);
+/* Copies blocks from the snapshot, where offset is a multiple of WORLD_SNAPSHOT_PAGE_SIZE */
+/* NOTE: This can be called from any thread */
+cc_result World_ReadSnapshot(cc_uint32 offset, cc_uint32 count, cc_bool upper, BlockRaw* dst);
+/* Ends the snapshot, freeing any copied pages */
+/* NOTE: If the world was reset while the snapshot was active, also frees the snapshot's blocks */
+void World_EndSnapshot(void);
+
 #ifdef EXTENDED_BLOCKS
 /* Sets World.Blocks2 and updates internal state for more than 256 blocks. */
 void World_SetMapUpper(BlockRaw* blocks);
@@ -114,6 +114,7 @@ void AudioBackend_LoadSounds(void) { Sounds_LoadDefault(); }
 *---------------------------------------------------Audio context code----------------------------------------------------*
 *#########################################################################################################################*/
 struct AudioContext music_ctx;
+struct AudioContext sounds_ctx;
 #ifndef POOL_MAX_CONTEXTS
 #define POOL_MAX_CONTEXTS 8
 #endif
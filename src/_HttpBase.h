@@ -26,6 +26,7 @@ void HttpRequest_Free(struct HttpRequest* request) {
 *----------------------------------------------------Http requests list---------------------------------------------------*
 *#########################################################################################################################*/
 #define HTTP_DEF_ELEMS 10
+enum HttpPriority { HTTP_PRIORITY_LOW, HTTP_PRIORITY_NORMAL, HTTP_PRIORITY_HIGH };
 
 struct RequestList {
 	int count, capacity;
@@ -40,22 +41,23 @@ static void RequestList_EnsureSpace(struct RequestList* list) {
 				sizeof(struct HttpRequest), HTTP_DEF_ELEMS, 10);
 }
 
-/* Adds a request to the list */
+/* Adds a request to the list, after all requests with the same or higher priority */
 static void RequestList_Append(struct RequestList* list, struct HttpRequest* item, cc_uint8 flags) {
 	int i;
 	RequestList_EnsureSpace(list);
 
 	if (flags & HTTP_FLAG_PRIORITY) {
-		/* Shift all requests right one place */
-		for (i = list->count; i > 0; i--) 
-		{
-			HttpRequest_Copy(&list->entries[i], &list->entries[i - 1]);
-		}
-		/* Insert new request at front/start */
-		i = 0;
+		item->priority = HTTP_PRIORITY_HIGH;
+	} else if (flags & HTTP_FLAG_BACKGROUND) {
+		item->priority = HTTP_PRIORITY_LOW;
 	} else {
-		/* Insert new request at end */
-		i = list->count;
+		item->priority = HTTP_PRIORITY_NORMAL;
+	}
+
+	/* Shift lower priority requests right one place */
+	for (i = list->count; i > 0 && list->entries[i - 1].priority < item->priority; i--) 
+	{
+		HttpRequest_Copy(&list->entries[i], &list->entries[i - 1]);
 	}
 
 	HttpRequest_Copy(&list->entries[i], item);
@@ -281,6 +283,8 @@ static int Http_Add(const cc_string* url, cc_uint8 flags, cc_uint8 type, const c
 	}
 	req.cookies  = cookies;
 	req.progress = HTTP_PROGRESS_NOT_WORKING_ON;
+	/* Caller is managing its own cache when it provides lastModified/etag */
+	req.diskCache = (flags & HTTP_FLAG_DISKCACHE) && type == REQUEST_TYPE_GET && !lastModified && !etag && !cookies;
 
 	HttpBackend_Add(&req, flags);
 	return req.id;
@@ -339,6 +343,8 @@ int Http_AsyncGetSkin(const cc_string* skinName, cc_uint8 flags) {
 	} else {
 		String_Format2(&url, "%s/%s.png", &skinServer, skinName);
 	}
+
+	if (!(flags & HTTP_FLAG_NOCACHE)) flags |= HTTP_FLAG_DISKCACHE;
 	return Http_AsyncGetData(&url, flags);
 }
 
@@ -409,9 +415,10 @@ static void Http_InitCommon(void) {
 	ScheduledTask2_Add(&Game_Tasks.http);
 }
 static void Http_Init(void);
+static void Http_Free(void);
 
 struct IGameComponent Http_Component = {
 	Http_Init,        /* Init  */
-	Http_ClearPending,/* Free  */
+	Http_Free,        /* Free  */
 	Http_ClearPending /* Reset */
 };
@@ -587,6 +587,49 @@ cc_result File_Length(cc_file file, cc_uint32* len) {
 }
 #endif
 
+#ifndef OVERRIDE_FILE_RENAME
+cc_result File_Rename(const cc_filepath* src, const cc_filepath* dst) {
+	return ERR_NOT_SUPPORTED;
+}
+#endif
+
+#ifndef OVERRIDE_FILE_DELETE
+cc_result File_Delete(const cc_filepath* path) {
+	return ERR_NOT_SUPPORTED;
+}
+#endif
+
+#ifndef OVERRIDE_THREAD_PROCESSORCOUNT
+int Thread_ProcessorCount(void) { return 1; }
+#endif
+
+#ifndef OVERRIDE_FILE_MAP
+/* No memory mapped files, so just read the entire file into memory instead */
+cc_result File_Map(cc_file file, void** data, cc_uint32* size) {
+	cc_uint32 total, read;
+	cc_uint8* ptr;
+	cc_result res;
+
+	if ((res = File_Length(file, size)))                  return res;
+	if ((res = File_Seek(file, 0, FILE_SEEKFROM_BEGIN))) return res;
+
+	ptr = (cc_uint8*)Mem_TryAlloc(*size, 1);
+	if (!ptr) return ERR_OUT_OF_MEMORY;
+
+	for (total = 0; total < *size; total += read) 
+	{
+		res = File_Read(file, ptr + total, *size - total, &read);
+		if (!res && !read) res = ERR_END_OF_STREAM;
+		if (res) { Mem_Free(ptr); return res; }
+	}
+
+	*data = ptr;
+	return 0;
+}
+
+void File_Unmap(void* data, cc_uint32 size) { Mem_Free(data); }
+#endif
+
 
 /*########################################################################################################################*
 *--------------------------------------------------------Threading--------------------------------------------------------*
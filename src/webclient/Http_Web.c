@@ -173,3 +173,6 @@ static void Http_Init(void) {
 	RequestList_Init(&processedReqs);
 }
 
+static void Http_Free(void) {
+	Http_ClearPending();
+}